@@ -1,15 +1,28 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include <malloc.h>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <cstring>
 #include <cstring>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <csignal>
+#include <thread>
 #include <type_traits>
+#include <vector>
+#include <xmmintrin.h>
 
 //#define GC_DIAGNOSTICS
 
@@ -28,7 +41,7 @@
 
 namespace memory {
 
-	namespace concept {
+	namespace concepts {
 
 		template<typename _to_t, typename _from_t>
 		using Assignable = typename std::enable_if < std::is_assignable<_to_t, _from_t>::value >::type;
@@ -151,22 +164,47 @@ namespace memory {
 		}
 
 		inline _t * reserve () noexcept {
+			auto * node = take();
+
+			// released nodes still carry their old links and fields, clear them
+			if constexpr (has_slot) {
+				// the slot identifies the node position within the pool, keep it
+				auto const slot = node->slot;
+				*node = {};
+				node->slot = slot;
+			} else {
+				*node = {};
+			}
+
+			return node;
+		}
+
+		inline void release (_t * node) noexcept {
+			_free_chain.prepend(node);
+		}
+
+		// a node as it was released, the caller clears it
+		inline _t * take () noexcept {
 			// if no more space in table "grow"
 			if (_free_chain.empty())
 				add_page();
 
-			auto * node = _free_chain.pop();
-			*node = {}; // TODO: think about if this is really needed
+			return _free_chain.pop();
+		}
 
-			return node;
+		// number of slots, reserved or not, handled by the pool
+		inline std::size_t slot_count () const noexcept {
+			return _node_pages.size() * _page_capacity;
 		}
 
-		inline void release (_t * node) noexcept {
-			_free_chain.prepend(node);
+		inline _t * node_at (std::size_t slot) const noexcept {
+			return _node_pages [slot / _page_capacity].get() + (slot % _page_capacity);
 		}
 
 	private:
 
+		static constexpr bool has_slot = requires (_t & n) { n.slot; };
+
 		inline void add_page () {
 			_node_pages.emplace_back (new _t [_page_capacity]);
 
@@ -185,6 +223,14 @@ namespace memory {
 
 			page [_page_capacity - 1].next = nullptr;
 
+			if constexpr (has_slot) {
+				auto const first_slot = (_node_pages.size() - 1) * _page_capacity;
+
+				for (std::size_t i = 0; i < _page_capacity; ++i) {
+					page[i].slot = static_cast < uint32_t > (first_slot + i);
+				}
+			}
+
 			_free_chain.head = page;
 		}
 
@@ -196,8 +242,9 @@ namespace memory {
 
 
 	struct node_flags {
-		bool marked : 1;
-		bool pinned : 1;
+		static constexpr uint8_t pinned = 1U << 0U;
+		static constexpr uint8_t remembered = 1U << 1U;
+		static constexpr uint8_t root = 1U << 2U;
 	};
 
 	using page_length = uint32_t;
@@ -211,11 +258,56 @@ namespace memory {
 
 	struct table_node;
 
+	// storage of a traced member reference, no table node is involved
+	struct field_ref {
+		table_node *	obj { nullptr };
+	};
+
+	// a run of count consecutive field_ref at offset bytes into an object
+	struct field_span {
+		uint32_t		offset;
+		uint32_t		count;
+	};
+
+	// precise layout of a type, where its traced references live
+	struct type_descriptor {
+		field_span const *	fields;
+		std::size_t			field_count;
+	};
+
+	// traced fields of a type, specialized through GC_FIELDS
+	template < typename _t >
+	struct gc_layout {
+		static constexpr std::array < field_span, 0 > fields {};
+	};
+
+	template < typename _field_t >
+	constexpr field_span make_field_span(std::size_t offset) {
+		using element_t = std::remove_all_extents_t < _field_t >;
+
+		static_assert(std::is_base_of_v < field_ref, element_t > && sizeof(element_t) == sizeof(field_ref), "only gc_field members can be traced");
+
+		return { static_cast < uint32_t > (offset), static_cast < uint32_t > (sizeof(_field_t) / sizeof(element_t)) };
+	}
+
+	// descriptor of a type, nullptr for types without traced fields
+	template < typename _t >
+	inline type_descriptor const * descriptor_of() noexcept {
+		if constexpr (gc_layout < _t >::fields.empty()) {
+			return nullptr;
+		} else {
+			static constexpr type_descriptor descriptor { gc_layout < _t >::fields.data(), gc_layout < _t >::fields.size() };
+			return &descriptor;
+		}
+	}
+
 	struct table_object {
 		node_chain < table_node >
 			ref_chain;
 		uint8_t *		ptr;
-		node_flags 		flags;
+		type_descriptor const *
+						type;
+		uint8_t 		flags;
 	};
 
 	struct table_ref {
@@ -232,13 +324,98 @@ namespace memory {
 			table_ref 	ref;
 		};
 
+		uint32_t		slot;
+
 		void print() {
 			std::cout << " -- obj (" << (void *)obj.ptr << ") ref (" << (void *)ref.to << ")\n\r";
 		}
 	};
 
+	// visit every object referenced by obj, registered references first then traced fields
+	template < typename _f >
+	inline void for_each_ref(table_node * obj, _f && visit) {
+		for (auto & ref : obj->obj.ref_chain) {
+			visit(ref.ref.to);
+		}
+
+		if (auto const * type = obj->obj.type) {
+			for (std::size_t i = 0; i < type->field_count; ++i) {
+				auto const & span = type->fields[i];
+				auto const * refs = reinterpret_cast < field_ref const * > (obj->obj.ptr + span.offset);
+
+				for (uint32_t k = 0; k < span.count; ++k) {
+					if (refs[k].obj)
+						visit(refs[k].obj);
+				}
+			}
+		}
+	}
+
+	// dense bit per node pool slot
+	struct slot_bitmap {
+	public:
+
+		static constexpr std::size_t word_bits = 64;
+
+		void resize(std::size_t slot_count) {
+			auto const words = (slot_count + word_bits - 1) / word_bits;
+
+			if (words > _words.size())
+				_words.resize(words, 0);
+		}
+
+		inline std::size_t word_count() const noexcept { return _words.size(); }
+		inline uint64_t const * words() const noexcept { return _words.data(); }
+
+		inline bool test(uint32_t slot) const noexcept {
+			return (_words[slot / word_bits] & bit_of(slot)) != 0;
+		}
+
+		inline void set(uint32_t slot) noexcept {
+			_words[slot / word_bits] |= bit_of(slot);
+		}
+
+		inline void reset(uint32_t slot) noexcept {
+			_words[slot / word_bits] &= ~bit_of(slot);
+		}
+
+		// atomic test-and-set, returns true if this call set the bit
+		inline bool try_set(uint32_t slot) noexcept {
+			std::atomic_ref < uint64_t > word { _words[slot / word_bits] };
+			auto const bit = bit_of(slot);
+
+			// cheap check first, avoids a locked instruction on bits already set
+			if ((word.load(std::memory_order_relaxed) & bit) != 0)
+				return false;
+
+			return (word.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+		}
+
+		inline void clear() noexcept {
+			std::memset(_words.data(), 0, _words.size() * sizeof(uint64_t));
+		}
+
+		std::size_t count() const noexcept {
+			std::size_t total = 0;
+
+			for (auto word : _words) {
+				total += static_cast < std::size_t > (std::popcount(word));
+			}
+
+			return total;
+		}
+
+	private:
+
+		static constexpr uint64_t bit_of(uint32_t slot) noexcept {
+			return uint64_t { 1 } << (slot % word_bits);
+		}
+
+		std::vector < uint64_t > _words;
+	};
+
 	struct alignas(8) page_header {
-		void(*destructor)(uint8_t *);
+		void(*destructor)(uint8_t *); // nullptr for trivially destructible types
 
 		page_header * next;
 		page_length length;
@@ -247,17 +424,21 @@ namespace memory {
 		inline uint8_t *begin() { return reinterpret_cast <uint8_t *> (this) + sizeof(page_header); }
 
 		inline uint8_t *end() { return begin() + length; }
+	};
 
-		inline void dispose() {
-			(*destructor)(begin());
+	// destructor of a collected type, nullptr when there is nothing to run
+	template < typename _t >
+	constexpr void (*destructor_of())(uint8_t *) {
+		if constexpr (std::is_trivially_destructible_v < _t >) {
+			return nullptr;
+		} else {
+			return [](uint8_t *ptr) { reinterpret_cast < _t * >(ptr)->~_t(); };
 		}
-	};
+	}
 
 
 	namespace buddy {
 
-		struct header_node;
-
 		struct header {
 			void * user_data;
 			bool free 				: 1;
@@ -284,22 +465,6 @@ namespace memory {
 			}
 		};
 
-		struct header_node {
-			header_node * prev;
-			header_node * next;
-
-			header * ptr;
-
-			inline void link (header * p) {
-				ptr = p;
-				p->user_data = this;
-			}
-
-			void node_print() {
-				std::cout << " -- ptr: " << (void *)ptr << "\n\r";
-			}
-		};
-
 		template<class _t>
 		constexpr inline _t next_pow_2(_t v) {
 			_t bit_ceil = sizeof(_t) * 8;
@@ -313,436 +478,2331 @@ namespace memory {
 			return v + 1;
 		}
 
-		struct page {
-		public:
+		// free blocks are tracked by one bitmap per level, a set bit marks a free block of that level.
+		// allocation takes the first free block of the smallest fitting level and splits it down, free
+		// merges with the buddy while the buddy bit is set. no free list nodes are involved
+		struct page {
+		public:
+
+			page (std::size_t capacity) :
+				_buffer_size { capacity },
+				_top_level { level_of (_buffer_size) },
+				_buffer{ new uint8_t [capacity] },
+				_free_levels { new free_bitmap [_top_level + 1] }
+			{
+				for (std::size_t level = 0; level <= _top_level; ++level) {
+					auto const blocks = _buffer_size >> (level + 5U);
+					_free_levels[level].words.resize ((blocks + 63) / 64, 0);
+				}
+
+				// a single free block spans the whole buffer
+				set_free (_top_level, 0);
+			}
+
+			// floor (log2 (length / 32)), 32 being the min size
+			static inline std::size_t level_of (std::size_t length) {
+				return static_cast < std::size_t > (std::bit_width (length)) - 6U;
+			}
+
+			// level of the block that fits an allocation of len bytes, same as level_of (next_pow_2 (len + sizeof (header)))
+			// without going through floating point, it runs on every allocation
+			static inline std::size_t level_for (std::size_t len) {
+				return static_cast < std::size_t > (std::bit_width (len + sizeof (header))) - 5U;
+			}
+
+			inline std::size_t capacity () const noexcept { return _buffer_size; }
+			inline std::size_t used () const noexcept { return _used; }
+			inline bool empty () const noexcept { return _used == 0; }
+
+			inline uint8_t const * data () const noexcept { return _buffer.get(); }
+
+			bool contains (header const * h) const noexcept {
+				auto const * ptr = reinterpret_cast < uint8_t const * > (h);
+				return ptr >= _buffer.get() && ptr < _buffer.get() + _buffer_size;
+			}
+
+			bool has_capacity (std::size_t len) const noexcept {
+				for (auto level = level_for (len); level <= _top_level; ++level) {
+					if (_free_levels[level].free_count != 0)
+						return true;
+				}
+
+				return false;
+			}
+
+			header * allocate (std::size_t len) {
+				if (auto * h = try_allocate (len))
+					return h;
+
+				throw std::runtime_error ("out of memory");
+			}
+
+			// nullptr when no free block fits
+			header * try_allocate (std::size_t len) {
+				auto const expected_level = level_for (len);
+				auto level = expected_level;
+
+				// find smallest fitting free block
+				std::size_t index;
+
+				while ((index = find_free (level)) == npos) {
+					++level;
+					if (level > _top_level) return nullptr;
+				}
+
+				clear_free (level, index);
+
+				// split blocks until expected length, keep the left half and free its buddy
+				while (level > expected_level) {
+					--level;
+					index *= 2;
+
+					set_free (level, index + 1);
+				}
+
+				_used += std::size_t { 32U } << expected_level;
+
+				return header::write (_buffer.get() + (index << (expected_level + 5U)), false, static_cast < uint8_t > (expected_level));
+			}
+
+			void free (header * h) {
+				std::size_t level = h->level;
+
+				auto const offset = static_cast < std::size_t > (reinterpret_cast < uint8_t * > (h) - _buffer.get());
+				auto index = offset >> (level + 5U);
+
+				h->free = true;
+				h->user_data = nullptr;
+
+				_used -= std::size_t { 32U } << level;
+
+				// coalescing, top level does not coalesce since its composed by a single block
+				while (level < _top_level && is_free (level, index ^ 1U)) {
+					clear_free (level, index ^ 1U);
+
+					index >>= 1U;
+					++level;
+				}
+
+				set_free (level, index);
+			}
+
+		private:
+
+			static constexpr std::size_t npos = ~std::size_t { 0 };
+
+			struct free_bitmap {
+				std::vector < uint64_t >	words;
+				std::size_t					first_word { 0 }; // no free block lives before this word
+				std::size_t					free_count { 0 };
+			};
+
+			inline bool is_free (std::size_t level, std::size_t index) const noexcept {
+				return (_free_levels[level].words[index / 64] & (uint64_t { 1 } << (index % 64))) != 0;
+			}
+
+			inline void set_free (std::size_t level, std::size_t index) noexcept {
+				auto & bitmap = _free_levels[level];
+
+				bitmap.words[index / 64] |= uint64_t { 1 } << (index % 64);
+				bitmap.first_word = std::min (bitmap.first_word, index / 64);
+				++bitmap.free_count;
+			}
+
+			inline void clear_free (std::size_t level, std::size_t index) noexcept {
+				auto & bitmap = _free_levels[level];
+
+				bitmap.words[index / 64] &= ~(uint64_t { 1 } << (index % 64));
+				--bitmap.free_count;
+			}
+
+			std::size_t find_free (std::size_t level) noexcept {
+				auto & bitmap = _free_levels[level];
+
+				// empty levels are common while splitting, don't scan them
+				if (bitmap.free_count == 0)
+					return npos;
+
+				for (; bitmap.first_word < bitmap.words.size(); ++bitmap.first_word) {
+					if (auto const word = bitmap.words[bitmap.first_word]; word != 0)
+						return bitmap.first_word * 64 + static_cast < std::size_t > (std::countr_zero (word));
+				}
+
+				return npos;
+			}
+
+			std::size_t const 					_buffer_size;
+			std::size_t const					_top_level;
+			std::size_t							_used { 0 };
+
+			std::unique_ptr < uint8_t [] > 		_buffer;
+			std::unique_ptr < free_bitmap [] >	_free_levels;
+		};
+
+		// growable set of buddy pages
+		// allocations stay on the current page until it can't fit them, then the emptiest page that
+		// fits becomes current, a new page is added when none does. pages left fully free are handed
+		// back to the system by release_free_pages
+		struct heap {
+		public:
+
+			explicit heap (std::size_t page_capacity) :
+				_page_capacity { page_capacity }
+			{
+				_current = add_page ();
+			}
+
+			header * allocate (std::size_t len) {
+				if (auto * h = _current->try_allocate (len)) [[likely]]
+					return h;
+
+				_current = emptiest_fit (len);
+
+				return _current->allocate (len);
+			}
+
+			void free (header * h) {
+				page_of (h)->free (h);
+			}
+
+			// release empty pages, a single empty page is kept around so a heap
+			// oscillating around a page boundary doesn't map and unmap on every cycle
+			// returns the number of pages released
+			std::size_t release_free_pages () {
+				std::size_t released = 0;
+
+				auto empty_count = static_cast < std::size_t > (
+					std::count_if (_pages.begin (), _pages.end (), [](auto const & p) { return p->empty (); }));
+
+				for (auto it = _pages.begin (); it != _pages.end () && empty_count > 1;) {
+					if ((*it)->empty ()) {
+						if (it->get () == _current)
+							_current = nullptr;
+
+						it = _pages.erase (it);
+						--empty_count;
+						++released;
+					} else {
+						++it;
+					}
+				}
+
+				if (!_current)
+					_current = emptiest_fit (0);
+
+				return released;
+			}
+
+			inline std::size_t page_count () const noexcept { return _pages.size (); }
+
+			std::size_t used_bytes () const noexcept {
+				std::size_t total = 0;
+
+				for (auto const & p : _pages) {
+					total += p->used ();
+				}
+
+				return total;
+			}
+
+		private:
+
+			page * emptiest_fit (std::size_t len) {
+				if (page::level_for (len) > page::level_of (_page_capacity))
+					throw std::runtime_error ("allocation larger than buddy page");
+
+				page * best = nullptr;
+
+				for (auto & p : _pages) {
+					if ((!best || p->used () < best->used ()) && p->has_capacity (len))
+						best = p.get ();
+				}
+
+				return best ? best : add_page ();
+			}
+
+			// pages are kept sorted by buffer address so a block maps to its page with a binary search
+			page * add_page () {
+				auto p = std::make_unique < page > (_page_capacity);
+				auto it = std::upper_bound (_pages.begin (), _pages.end (), p->data (),
+					[](uint8_t const * data, auto const & other) { return data < other->data (); });
+
+				return _pages.insert (it, std::move (p))->get ();
+			}
+
+			page * page_of (header * h) {
+				auto it = std::upper_bound (_pages.begin (), _pages.end (), reinterpret_cast < uint8_t const * > (h),
+					[](uint8_t const * ptr, auto const & other) { return ptr < other->data (); });
+
+				check_break (it != _pages.begin () && (*std::prev (it))->contains (h));
+
+				return std::prev (it)->get ();
+			}
+
+			std::size_t const							_page_capacity;
+			std::vector < std::unique_ptr < page > >	_pages;
+			page *										_current { nullptr };
+		};
+
+	}
+
+	struct table {
+	public:
+
+		table() {
+			_root = _available_nodes.reserve ();
+		}
+		 
+		inline table_node * get_root() const { return _root; }
+
+		table_node *add_obj_node() {
+			auto * node = reserve_node();
+
+			register_obj_node(node);
+
+#ifdef GC_DIAGNOSTICS
+			for_each_object([&](table_node * o) {
+				check_break(o == node || o->obj.ptr);
+				check_break(o == node || !buddy::header::from_ptr(o->obj.ptr)->free);
+			});
+#endif
+
+			return node;
+		}
+
+		// a blank node that is neither an object nor a reference yet
+		table_node *reserve_node() {
+			auto * node = _available_nodes.reserve ();
+
+			// keep the side bitmaps covering every pool slot
+			_object_slots.resize(_available_nodes.slot_count());
+			_marks.resize(_available_nodes.slot_count());
+
+			return node;
+		}
+
+		inline void release_node(table_node *node) noexcept {
+			_available_nodes.release(node);
+		}
+
+		// count nodes as they were released, the caller clears them before use
+		template < typename _f >
+		void take_nodes(std::size_t count, _f && take) {
+			for (std::size_t i = 0; i < count; ++i) {
+				take(_available_nodes.take());
+			}
+
+			_object_slots.resize(_available_nodes.slot_count());
+			_marks.resize(_available_nodes.slot_count());
+		}
+
+		// make a reserved node part of the sweep
+		inline void register_obj_node(table_node *object) noexcept {
+			_object_slots.set(object->slot);
+		}
+
+		table_node *add_ref_node(table_node *from_object, table_node *to_object) {
+			return link_ref_node(from_object, to_object, _available_nodes.reserve());
+		}
+
+		// turn a reserved node into a reference from from_object to to_object
+		inline table_node *link_ref_node(table_node *from_object, table_node *to_object, table_node *node) noexcept {
+			from_object->obj.ref_chain.prepend(node);
+			node->ref.to = to_object;
+
+			return node;
+		}
+
+		void rem_obj_node(table_node *object) {
+			// -- clear refs --
+			// theoretically they should clear themselves but...
+			object->obj.ref_chain.clear([&](table_node * n) { _available_nodes.release (n); });
+			// remove object, registered or not
+			_object_slots.reset(object->slot);
+			_available_nodes.release(object);
+		}
+
+		// take an object out of the sweep while keeping its node and references, rem_obj_node still releases it
+		void detach_obj_node(table_node *object) {
+			_object_slots.reset(object->slot);
+		}
+
+		void rem_ref_node(table_node *from_object, table_node *ref) {
+			unlink_ref_node(from_object, ref);
+			_available_nodes.release (ref);
+		}
+
+		// unhook a reference, the node is left to the caller
+		inline void unlink_ref_node(table_node *from_object, table_node *ref) noexcept {
+			from_object->obj.ref_chain.remove (ref);
+		}
+
+		inline std::size_t object_count() const noexcept { return _object_slots.count(); }
+
+		// visit every registered object node
+		template < typename _f >
+		void for_each_object(_f && visit) {
+			auto const word_count = _object_slots.word_count();
+			auto const * objects = _object_slots.words();
+
+			for (std::size_t i = 0; i < word_count; ++i) {
+				for (auto word = objects[i]; word != 0; word &= word - 1) {
+					visit(_available_nodes.node_at(i * slot_bitmap::word_bits + static_cast < std::size_t > (std::countr_zero(word))));
+				}
+			}
+		}
+
+		// mark state lives in a side bitmap, node cache lines stay clean while collecting
+		inline bool is_marked(table_node const * node) const noexcept { return _marks.test(node->slot); }
+		inline bool try_mark(table_node * node) noexcept { return _marks.try_set(node->slot); }
+		inline void mark(table_node * node) noexcept { _marks.set(node->slot); }
+		inline void unmark(table_node * node) noexcept { _marks.reset(node->slot); }
+		inline void clear_marks() noexcept { _marks.clear(); }
+
+		// visit every object node left unmarked
+		template < typename _f >
+		void for_each_unmarked(_f && visit) {
+			auto const word_count = _object_slots.word_count();
+			auto const * objects = _object_slots.words();
+			auto const * marks = _marks.words();
+
+			_sweep_words.resize(word_count);
+
+			// allocated and not marked, straight line loop the compiler can vectorize
+			for (std::size_t i = 0; i < word_count; ++i) {
+				_sweep_words[i] = objects[i] & ~marks[i];
+			}
+
+			for (std::size_t i = 0; i < word_count; ++i) {
+				for (auto word = _sweep_words[i]; word != 0; word &= word - 1) {
+					auto const slot = i * slot_bitmap::word_bits + static_cast < std::size_t > (std::countr_zero(word));
+					visit(_available_nodes.node_at(slot));
+				}
+			}
+		}
+
+		inline std::size_t slot_word_count() const noexcept { return _object_slots.word_count(); }
+
+		/// visit object nodes left unmarked within the bitmap words [first, last), for sweeps split in steps
+		/// \return number of visited nodes
+		template < typename _f >
+		std::size_t for_each_unmarked(std::size_t first, std::size_t last, _f && visit) {
+			auto const * objects = _object_slots.words();
+			auto const * marks = _marks.words();
+
+			std::size_t count = 0;
+
+			for (std::size_t i = first; i < last; ++i) {
+				// the word is read up front, visit may unregister the nodes it gets
+				for (auto word = objects[i] & ~marks[i]; word != 0; word &= word - 1, ++count) {
+					visit(_available_nodes.node_at(i * slot_bitmap::word_bits + static_cast < std::size_t > (std::countr_zero(word))));
+				}
+			}
+
+			return count;
+		}
+
+	private:
+		node_pool < table_node > 	_available_nodes 	{ 4096 };
+		table_node * 				_root 				{ nullptr };
+
+		slot_bitmap					_object_slots;
+		slot_bitmap					_marks;
+		std::vector < uint64_t >	_sweep_words;
+	};
+
+	struct spin_mutex {
+		void lock() noexcept {
+			for (;;) {
+				// Optimistically assume the lock is free on the first try
+				if (!_lock.exchange(true, std::memory_order_acquire))
+					return;
+
+				// Wait for lock to be released without generating cache misses
+				while (_lock.load(std::memory_order_relaxed))
+					_mm_pause();
+			}
+		}
+
+		bool try_lock() noexcept {
+			return !_lock.load(std::memory_order_relaxed) && !_lock.exchange(true, std::memory_order_acquire);
+		}
+
+		void unlock() noexcept {
+			_lock.store(false, std::memory_order_release);
+		}
+
+	private:
+		std::atomic_bool _lock { false };
+	};
+
+	// pooled collector threads, a job runs on every worker at once
+	// the calling thread always works as worker 0, additional workers are pooled
+	struct worker_pool {
+	public:
+
+		explicit worker_pool(std::size_t thread_count = 1) {
+			set_thread_count(thread_count);
+		}
+
+		~worker_pool() {
+			stop_workers();
+		}
+
+		worker_pool(worker_pool const &) = delete;
+		worker_pool & operator=(worker_pool const &) = delete;
+
+		inline std::size_t thread_count() const noexcept { return _thread_count; }
+
+		void set_thread_count(std::size_t thread_count) {
+			thread_count = std::max < std::size_t >(thread_count, 1);
+
+			if (thread_count == _thread_count)
+				return;
+
+			stop_workers();
+
+			_thread_count = thread_count;
+
+			// workers capture the epoch here, so a job issued right after can't be missed
+			auto const epoch = _epoch.load(std::memory_order_acquire);
+
+			for (std::size_t i = 1; i < _thread_count; ++i) {
+				_workers.emplace_back([this, i, epoch] { worker_main(i, epoch); });
+			}
+		}
+
+		// run job(worker_index) on every worker, returns once all of them are done
+		template < typename _f >
+		void run(_f && job) {
+			if (_thread_count == 1) {
+				job(std::size_t { 0 });
+				return;
+			}
+
+			_job = [](void * context, std::size_t index) { (*static_cast < std::remove_reference_t < _f > * > (context))(index); };
+			_job_context = &job;
+
+			_finished.store(0, std::memory_order_relaxed);
+
+			// wake up the pool
+			_epoch.fetch_add(1, std::memory_order_release);
+			_epoch.notify_all();
+
+			job(std::size_t { 0 });
+
+			// wait for the rest of the pool
+			auto const helpers = _thread_count - 1;
+
+			for (auto finished = _finished.load(std::memory_order_acquire);
+				 finished != helpers;
+				 finished = _finished.load(std::memory_order_acquire))
+			{
+				_finished.wait(finished, std::memory_order_acquire);
+			}
+		}
+
+	private:
+
+		void worker_main(std::size_t index, uint64_t epoch) {
+			for (;;) {
+				_epoch.wait(epoch, std::memory_order_acquire);
+				epoch = _epoch.load(std::memory_order_acquire);
+
+				if (_stopping.load(std::memory_order_acquire))
+					return;
+
+				_job(_job_context, index);
+
+				_finished.fetch_add(1, std::memory_order_release);
+				_finished.notify_one();
+			}
+		}
+
+		void stop_workers() {
+			if (_workers.empty())
+				return;
+
+			_stopping.store(true, std::memory_order_release);
+			_epoch.fetch_add(1, std::memory_order_release);
+			_epoch.notify_all();
+
+			_workers.clear();
+			_stopping.store(false, std::memory_order_relaxed);
+		}
+
+		std::size_t							_thread_count { 0 };
+		std::vector < std::jthread >		_workers;
+
+		void (*_job)(void *, std::size_t) { nullptr };
+		void *								_job_context { nullptr };
+
+		std::atomic_uint64_t				_epoch { 0 };
+		std::atomic_size_t					_finished { 0 };
+		std::atomic_bool					_stopping { false };
+	};
+
+	// mark phase, one gray stack per worker with work stealing
+	struct parallel_marker {
+	public:
+
+		void mark(table & tbl, worker_pool & pool) {
+			auto * root = tbl.get_root();
+
+			if (_thread_count != pool.thread_count()) {
+				_thread_count = pool.thread_count();
+				_stacks.reset(new gray_stack [_thread_count]);
+			}
+
+			for (std::size_t i = 0; i < _thread_count; ++i) {
+				_stacks[i].peak = 0;
+			}
+
+			_table = &tbl;
+			_table->mark(root);
+			_stacks[0].local.push_back(root);
+
+			_active.store(_thread_count, std::memory_order_relaxed);
+
+			pool.run([this](std::size_t index) { run_worker(index); });
+		}
+
+		// peak gray set of the last mark, summed over the private stacks of every worker
+		std::size_t peak_gray() const noexcept {
+			std::size_t total = 0;
+
+			for (std::size_t i = 0; i < _thread_count; ++i) {
+				total += _stacks[i].peak;
+			}
+
+			return total;
+		}
+
+	private:
+
+		// nodes are traced from the private stack, surplus is shared for thieves
+		struct alignas(64) gray_stack {
+			std::vector < table_node * >	local;
+			std::size_t						peak { 0 };
+
+			spin_mutex						mutex;
+			std::vector < table_node * >	shared;
+			std::atomic_size_t				shared_size { 0 };
+		};
+
+		static constexpr std::size_t share_threshold = 64;
+
+		void trace(gray_stack & stack, table_node * node) {
+			for_each_ref(node, [&](table_node * to) {
+				if (_table->try_mark(to))
+					stack.local.push_back(to);
+			});
+		}
+
+		// move half of the private stack to the shared stack if thieves took everything there
+		void share(gray_stack & stack) {
+			if (stack.local.size() < share_threshold || stack.shared_size.load(std::memory_order_relaxed) != 0)
+				return;
+
+			auto const half = static_cast < std::ptrdiff_t > (stack.local.size() / 2);
+
+			std::scoped_lock lock { stack.mutex };
+
+			stack.shared.insert(stack.shared.end(), stack.local.begin(), stack.local.begin() + half);
+			stack.local.erase(stack.local.begin(), stack.local.begin() + half);
+
+			stack.shared_size.store(stack.shared.size(), std::memory_order_relaxed);
+		}
+
+		// move half of the shared work of a victim into the private stack
+		bool take(gray_stack & victim, gray_stack & stack) {
+			if (victim.shared_size.load(std::memory_order_relaxed) == 0)
+				return false;
+
+			std::scoped_lock lock { victim.mutex };
+
+			if (victim.shared.empty())
+				return false;
+
+			auto const count = static_cast < std::ptrdiff_t > ((victim.shared.size() + 1) / 2);
+			auto const first = victim.shared.end() - count;
+
+			stack.local.insert(stack.local.end(), first, victim.shared.end());
+			victim.shared.erase(first, victim.shared.end());
+
+			victim.shared_size.store(victim.shared.size(), std::memory_order_relaxed);
+
+			return true;
+		}
+
+		bool steal(std::size_t index) {
+			auto & stack = _stacks[index];
+
+			// own shared work first
+			if (take(stack, stack))
+				return true;
+
+			for (std::size_t i = 1; i < _thread_count; ++i) {
+				if (take(_stacks[(index + i) % _thread_count], stack))
+					return true;
+			}
+
+			return false;
+		}
+
+		bool has_shared_work() const {
+			for (std::size_t i = 0; i < _thread_count; ++i) {
+				if (_stacks[i].shared_size.load(std::memory_order_relaxed) != 0)
+					return true;
+			}
+
+			return false;
+		}
+
+		void run_worker(std::size_t index) {
+			auto & stack = _stacks[index];
+
+			for (;;) {
+				// drain the private stack
+				while (!stack.local.empty()) {
+					auto * node = stack.local.back();
+					stack.local.pop_back();
+
+					trace(stack, node);
+
+					stack.peak = std::max(stack.peak, stack.local.size());
+
+					if (_thread_count > 1)
+						share(stack);
+				}
+
+				if (_thread_count == 1)
+					return;
+
+				if (!steal(index) && !await_work(index))
+					return;
+			}
+		}
+
+		// termination detection, a worker counts as active while it may still produce work
+		// returns false once every worker ran out of work
+		bool await_work(std::size_t index) {
+			_active.fetch_sub(1, std::memory_order_acq_rel);
+
+			for (uint32_t spin = 0;; ++spin) {
+				if (has_shared_work()) {
+					_active.fetch_add(1, std::memory_order_acq_rel);
+
+					if (steal(index))
+						return true;
+
+					_active.fetch_sub(1, std::memory_order_acq_rel);
+				}
+
+				if (_active.load(std::memory_order_acquire) == 0)
+					return false;
+
+				// back off to the scheduler when there are more workers than free cores
+				if (spin < 64)
+					_mm_pause();
+				else
+					std::this_thread::yield();
+			}
+		}
+
+		std::size_t							_thread_count { 0 };
+		table *								_table { nullptr };
+		std::unique_ptr < gray_stack [] >	_stacks;
+
+		std::atomic_size_t					_active { 0 };
+	};
+
+	// unreachable objects waiting for their destructor
+	// destructors run in batches on the mutator, outside of the collection pause, and in no particular
+	// order. they may unregister their own references but must not dereference gc references, the
+	// targets may be gone already. the object node stays reserved until its destructor ran
+	struct finalizer_queue {
+	public:
+
+		struct entry {
+			table_node *	node;
+			void (*destructor)(uint8_t *);
+			uint8_t *		ptr;
+		};
+
+		inline bool empty() const noexcept { return _next == _entries.size(); }
+		inline std::size_t size() const noexcept { return _entries.size() - _next; }
+
+		void push(entry e) {
+			_entries.push_back(e);
+		}
+
+		// copy an object that is about to be overwritten, copies stay put until the queue drains
+		uint8_t * stash(uint8_t const * data, std::size_t length) {
+			std::size_t const aligned = align_length(static_cast < page_length > (length), alignof(std::max_align_t));
+
+			if (_chunks.empty() || _chunk_offset + aligned > _chunks.back().capacity) {
+				std::size_t const capacity = std::max(chunk_size, aligned);
+				_chunks.push_back({ std::unique_ptr < uint8_t [] > { new uint8_t [capacity] }, capacity });
+				_chunk_offset = 0;
+			}
+
+			auto * copy = _chunks.back().data.get() + _chunk_offset;
+			_chunk_offset += aligned;
+
+			std::memcpy(copy, data, length);
+
+			return copy;
+		}
+
+		/// run up to max_count destructors, release(entry) is called after each of them
+		/// \return number of destructors that ran
+		/// \note destructors may allocate and collect, objects queued meanwhile are run by the same call
+		template < typename _release_f >
+		std::size_t run(std::size_t max_count, _release_f && release) {
+			if (_running)
+				return 0;
+
+			_running = true;
+
+			std::size_t count = 0;
+
+			for (; count < max_count && _next < _entries.size(); ++count) {
+				auto e = _entries[_next++];
+
+				e.destructor(e.ptr);
+				release(e);
+			}
+
+			if (empty()) {
+				_entries.clear();
+				_next = 0;
+
+				// keep the largest chunk around for the next collection
+				if (!_chunks.empty()) {
+					std::swap(_chunks.front(), *std::ranges::max_element(_chunks, {}, &chunk::capacity));
+					_chunks.resize(1);
+				}
+
+				_chunk_offset = 0;
+			}
+
+			_running = false;
+
+			return count;
+		}
+
+	private:
+
+		static constexpr std::size_t chunk_size = 64 * 1024;
+
+		// stashed objects larger than chunk_size get a chunk of their own size
+		struct chunk {
+			std::unique_ptr < uint8_t [] >	data;
+			std::size_t						capacity;
+		};
+
+		std::vector < entry >							_entries;
+		std::size_t										_next { 0 };
+
+		std::vector < chunk >							_chunks;
+		std::size_t										_chunk_offset { 0 };
+
+		bool											_running { false };
+	};
+
+	template<std::size_t capacity>
+	struct page {
+	public:
+
+		page_header *begin() { return reinterpret_cast < page_header * > (_buffer); }
+
+		page_header *end() { return reinterpret_cast < page_header * > (_offset); }
+
+		page() = default;
+
+		inline page(page &&p) noexcept :
+			_buffer { nullptr },
+			_offset { nullptr }
+		{
+			this->swap(p);
+		}
+
+		inline page &operator=(page &&p) noexcept {
+			this->swap(p);
+			return *this;
+		}
+
+		~page() {
+			free(_buffer);
+		}
+
+		void swap(page &p) noexcept {
+			using std::swap;
+			swap(_buffer, p._buffer);
+			swap(_offset, p._offset);
+		}
+
+		void reset() {
+			_offset = _buffer;
+		}
+
+		static constexpr bool fits(page_length length) noexcept {
+			return capacity >= align_length(length, 8) + sizeof(page_header);
+		}
+
+		bool has_capacity(page_length length) const noexcept {
+			// account for the block header and the alignment padding added by allocate
+			return capacity >= ((_offset - _buffer) + align_length(length, 8) + sizeof(page_header));
+		}
+
+		bool empty() const noexcept {
+			return _offset == _buffer;
+		}
+
+		std::size_t used() const noexcept {
+			return static_cast < std::size_t > (_offset - _buffer);
+		}
+
+		std::size_t remaining() const noexcept {
+			return capacity - static_cast < std::size_t > (_offset - _buffer);
+		}
+
+		// hand out a raw run of the page, the caller fills it with blocks
+		uint8_t *carve(std::size_t length) noexcept {
+			if (remaining() < length)
+				return nullptr;
+
+			auto * run = _offset;
+			_offset += length;
+
+			return run;
+		}
+
+		bool contains(uint8_t const * ptr) const noexcept {
+			return ptr >= _buffer && ptr < _buffer + capacity;
+		}
+
+		page_header *allocate(page_length length) {
+			auto *header = end();
+
+			length = align_length(length, 8);
+
+			_offset += (length + sizeof(page_header));
+
+			header->next = end();
+			header->length = length;
+
+			return header;
+		}
+
+		page_header *move_allocated(page_header *header) {
+			auto alloc_header = allocate(header->length);
+
+			alloc_header->node = header->node;
+			alloc_header->destructor = header->destructor;
+
+			// alignment issues
+			std::copy(header->begin(), header->end(), alloc_header->begin());
+
+			return alloc_header;
+		}
+
+		// copy a block to an offset decided up front, blocks placed this way are only
+		// visible once the page is resized to cover them
+		page_header *move_allocated_at(page_length offset, page_header *header) {
+			auto alloc_header = reinterpret_cast < page_header * > (_buffer + offset);
+
+			alloc_header->length = header->length;
+			alloc_header->next = reinterpret_cast < page_header * > (alloc_header->end());
+			alloc_header->node = header->node;
+			alloc_header->destructor = header->destructor;
+
+			std::copy(header->begin(), header->end(), alloc_header->begin());
+
+			return alloc_header;
+		}
+
+		void resize(page_length size) {
+			_offset = _buffer + size;
+		}
+
+	private:
+		uint8_t *_buffer{
+			reinterpret_cast < uint8_t * > (malloc(capacity))
+		};
+
+		uint8_t *_offset{_buffer};
+	};
+
+	// thread local allocation buffer, a run of nursery memory a single mutator bump allocates from
+	// the tail always keeps room for a filler header, so a retired buffer leaves the nursery walkable
+	struct tlab {
+	public:
+
+		inline bool empty() const noexcept { return _cursor == nullptr; }
+
+		void reset(uint8_t * run, std::size_t length) noexcept {
+			_cursor = run;
+			_limit = run + length - sizeof(page_header);
+		}
+
+		inline page_header *allocate(page_length length) noexcept {
+			std::size_t const size = align_length(length, 8) + sizeof(page_header);
+
+			if (static_cast < std::size_t > (_limit - _cursor) < size)
+				return nullptr;
+
+			auto * header = reinterpret_cast < page_header * > (_cursor);
+			_cursor += size;
+
+			header->next = reinterpret_cast < page_header * > (_cursor);
+			header->length = static_cast < page_length > (size - sizeof(page_header));
+
+			return header;
+		}
+
+		// seal the unused tail with a block that has no node
+		void retire() noexcept {
+			if (empty())
+				return;
+
+			auto * filler = reinterpret_cast < page_header * > (_cursor);
+			auto * run_end = _limit + sizeof(page_header);
+
+			filler->destructor = nullptr;
+			filler->node = nullptr;
+			filler->length = static_cast < page_length > (run_end - filler->begin());
+			filler->next = reinterpret_cast < page_header * > (run_end);
+
+			_cursor = nullptr;
+			_limit = nullptr;
+		}
+
+	private:
+		uint8_t *	_cursor { nullptr };
+		uint8_t *	_limit { nullptr };
+	};
+
+	template<std::size_t page_size>
+	struct paging {
+
+		using page_type = page<page_size>;
+
+		std::vector<page_type> pages;
+
+		paging() {
+			// add active page
+			pages.emplace_back();
+		}
+
+		page_header *allocate(page_length length) {
+			if (!pages.back().has_capacity(length)) {
+				add_page();
+			}
+
+			auto alloc = pages.back().allocate(length);
+
+			return alloc;
+		}
+
+		page_header *move_allocated(page_header *header) {
+			if (!pages.back().has_capacity(header->length)) {
+				add_page();
+			}
+
+			return pages.back().move_allocated(header);
+		}
+
+		std::size_t used_bytes() const noexcept {
+			std::size_t total = 0;
+
+			for (auto const & page : pages) {
+				total += page.used();
+			}
+
+			return total;
+		}
+
+		/// sweep dead blocks and slide the live ones into fresh pages, keeping their allocation order
+		/// \note live bytes are summed per page in parallel, a prefix sum over the pages gives every
+		///       page its destination offset and the pages are then moved in parallel. a page never
+		///       splits across destination pages, which costs at most one page worth of tail per page.
+		/// \note dead(block) is called on the calling thread for every dead block before it is overwritten
+		/// \note the counting pass walks every block a second time, with at most two pages moving at once
+		///       the blocks are slid in a single pass on the calling thread instead
+		/// \return number of pages freed by the compaction
+		template < typename _dead_f >
+		std::size_t compress(table const & tbl, worker_pool & pool, _dead_f && dead) {
+			auto const page_count = pages.size();
+
+			if (std::min(page_count, pool.thread_count()) <= 2) {
+				begin_compress();
+				compress_step(tbl, [](std::size_t) { return false; }, dead);
+
+				return page_count > pages.size() ? page_count - pages.size() : 0;
+			}
+
+			_live_bytes.assign(page_count, 0);
+			_dead_blocks.resize(page_count);
+
+			// count live bytes and collect dead blocks
+			std::atomic_size_t next_page { 0 };
+
+			pool.run([&](std::size_t) {
+				for (auto i = next_page.fetch_add(1, std::memory_order_relaxed); i < page_count; i = next_page.fetch_add(1, std::memory_order_relaxed)) {
+					auto & dead = _dead_blocks[i];
+					page_length live = 0;
+
+					dead.clear();
+
+					for (auto *block_it = pages[i].begin(); block_it != pages[i].end(); block_it = block_it->next) {
+						if (tbl.is_marked(block_it->node))
+							live += block_it->length + sizeof(page_header);
+						else
+							dead.push_back(block_it);
+					}
+
+					_live_bytes[i] = live;
+				}
+			});
+
+			for (auto & blocks : _dead_blocks) {
+				for (auto * block : blocks) {
+					dead(block);
+				}
+			}
+
+			// forwarding, prefix sum of live bytes starting a new page whenever the next one doesn't fit
+			_forward.resize(page_count);
+
+			std::size_t dest_count = 0;
+			page_length dest_offset = 0;
+
+			for (std::size_t i = 0; i < page_count; ++i) {
+				if (_live_bytes[i] == 0)
+					continue;
+
+				if (dest_count == 0 || dest_offset + _live_bytes[i] > page_size) {
+					++dest_count;
+					dest_offset = 0;
+				}
+
+				_forward[i] = { dest_count - 1, dest_offset };
+				dest_offset += _live_bytes[i];
+			}
+
+			// always leave a page to allocate from
+			dest_count = std::max < std::size_t > (dest_count, 1);
+
+			while (_spare_pages.size() < dest_count) {
+				_spare_pages.emplace_back();
+			}
+
+			std::vector<page_type> dest_pages;
+			dest_pages.reserve(dest_count);
+
+			for (std::size_t i = 0; i < dest_count; ++i) {
+				dest_pages.push_back(std::move(_spare_pages.back()));
+				_spare_pages.pop_back();
+				dest_pages.back().reset();
+			}
+
+			// move live blocks
+			next_page.store(0, std::memory_order_relaxed);
+
+			pool.run([&](std::size_t) {
+				for (auto i = next_page.fetch_add(1, std::memory_order_relaxed); i < page_count; i = next_page.fetch_add(1, std::memory_order_relaxed)) {
+					if (_live_bytes[i] == 0)
+						continue;
+
+					auto & dest = dest_pages[_forward[i].page];
+					auto offset = _forward[i].offset;
+
+					for (auto *block_it = pages[i].begin(); block_it != pages[i].end(); block_it = block_it->next) {
+						if (!tbl.is_marked(block_it->node))
+							continue;
+
+						auto alloc = dest.move_allocated_at(offset, block_it);
+						block_it->node->obj.ptr = alloc->begin();
+
+						offset += block_it->length + sizeof(page_header);
+					}
+				}
+			});
+
+			for (std::size_t i = 0; i < page_count; ++i) {
+				if (_live_bytes[i] != 0)
+					dest_pages[_forward[i].page].resize(_forward[i].offset + _live_bytes[i]);
+			}
+
+			// source pages are kept for the next collection, up to the size of the live heap
+			for (auto & page : pages) {
+				if (_spare_pages.size() >= dest_count)
+					break;
+
+				_spare_pages.push_back(std::move(page));
+			}
+
+			pages = std::move(dest_pages);
+
+			return page_count > dest_count ? page_count - dest_count : 0;
+		}
+
+		/// start a compaction that runs in steps, the pages become its source and allocation moves on to a fresh page
+		/// \note blocks allocated until compress_step completes must be marked, only the source pages are swept
+		/// \return number of source pages
+		std::size_t begin_compress() {
+			_from_pages = std::move(pages);
+			_from_page = 0;
+			_from_block = _from_pages.front().begin();
+
+			pages.clear();
+			add_page();
+
+			return _from_pages.size();
+		}
+
+		/// slide live blocks of the source pages behind the allocated ones, one block at a time
+		/// \note expired(units) is asked before each block, a unit per block and per 256 bytes it holds.
+		///       the step returns as soon as it answers true and the next one resumes at that block
+		/// \note dead(block) is called on the calling thread for every dead block before it is overwritten
+		/// \return true once every source page is swept
+		template < typename _expired_f, typename _dead_f >
+		bool compress_step(table const & tbl, _expired_f && expired, _dead_f && dead) {
+			for (; _from_page < _from_pages.size(); ++_from_page) {
+				auto & source = _from_pages[_from_page];
+
+				for (; _from_block != source.end(); _from_block = _from_block->next) {
+					if (expired(1 + _from_block->length / 256))
+						return false;
+
+					if (tbl.is_marked(_from_block->node)) {
+						auto alloc = move_allocated(_from_block);
+						_from_block->node->obj.ptr = alloc->begin();
+					} else {
+						dead(_from_block);
+					}
+				}
+
+				// every live block left the page, it can take the next ones
+				_spare_pages.push_back(std::move(source));
+
+				if (_from_page + 1 < _from_pages.size())
+					_from_block = _from_pages[_from_page + 1].begin();
+			}
+
+			_from_pages.clear();
+
+			// source pages are kept for the next collection, up to the size of the heap
+			if (_spare_pages.size() > pages.size())
+				_spare_pages.resize(pages.size());
+
+			return true;
+		}
+
+	private:
+
+		// grow by a spare page if there is one
+		void add_page() {
+			if (_spare_pages.empty()) {
+				pages.emplace_back();
+			} else {
+				pages.push_back(std::move(_spare_pages.back()));
+				_spare_pages.pop_back();
+				pages.back().reset();
+			}
+		}
+
+		struct forward {
+			std::size_t	page;
+			page_length	offset;
+		};
+
+		std::vector<page_type>		_spare_pages;
+		std::vector<page_length>	_live_bytes;
+		std::vector<forward>		_forward;
+		std::vector<std::vector<page_header *>>
+									_dead_blocks;
+
+		// source of a compaction running in steps
+		std::vector<page_type>		_from_pages;
+		std::size_t					_from_page { 0 };
+		page_header *				_from_block { nullptr };
+	};
+
+	using stats_clock = std::chrono::steady_clock;
+
+	inline std::chrono::nanoseconds elapsed_since(stats_clock::time_point start) noexcept {
+		return std::chrono::duration_cast < std::chrono::nanoseconds > (stats_clock::now() - start);
+	}
+
+	// time left to a slice of an incremental cycle, work is counted in units and the clock is only
+	// read once every check_interval units
+	struct slice_budget {
+	public:
+
+		static constexpr std::size_t check_interval = 64;
+
+		explicit slice_budget(stats_clock::time_point deadline) noexcept :
+			_deadline { deadline }
+		{}
+
+		inline bool expired(std::size_t units = 1) noexcept {
+			_work += units;
+
+			if (_work < check_interval)
+				return false;
+
+			_work = 0;
+
+			return stats_clock::now() >= _deadline;
+		}
+
+	private:
+		stats_clock::time_point	_deadline;
+		std::size_t				_work { 0 };
+	};
+
+	enum struct cycle_kind : uint8_t {
+		minor,
+		full,
+		incremental
+	};
+
+	inline char const * to_string(cycle_kind kind) noexcept {
+		switch (kind) {
+			case cycle_kind::minor:			return "minor";
+			case cycle_kind::full:			return "full";
+			case cycle_kind::incremental:	return "incremental";
+		}
+
+		return "unknown";
+	}
+
+	// statistics of one collection cycle
+	// an incremental cycle spans several slices, pause is the longest of them while mark adds them all up.
+	// objects and bytes count the nursery as well, bytes are the ones taken from the heap pages
+	struct cycle_stats {
+		uint64_t					cycle { 0 };
+		cycle_kind					kind { cycle_kind::full };
+
+		std::size_t					objects_before { 0 };
+		std::size_t					objects_after { 0 };
+		std::size_t					survivors { 0 };
+		std::size_t					bytes_before { 0 };
+		std::size_t					bytes_after { 0 };
+
+		std::size_t					pages_recycled { 0 };
+		std::size_t					peak_gray { 0 };
+		std::size_t					slices { 0 };
+
+		std::chrono::nanoseconds	pause {};
+		std::chrono::nanoseconds	mark {};
+		std::chrono::nanoseconds	compress {};
+		std::chrono::nanoseconds	sweep {};
+	};
+
+	// cycles kept by the telemetry of each collector
+	constexpr std::size_t telemetry_capacity = 1024;
+
+	// ring buffer with the statistics of the last telemetry_capacity cycles, the oldest are overwritten first
+	// cycles are recorded by the collection itself, queries are not synchronized with running collections
+	struct telemetry {
+	public:
+
+		void record(cycle_stats stats) {
+			stats.cycle = _next_cycle++;
+
+			_cycles[_recorded % telemetry_capacity] = stats;
+			++_recorded;
+
+			if (_log)
+				write_json(*_log, stats);
+		}
+
+		// cycles held, at most telemetry_capacity
+		inline std::size_t size() const noexcept { return std::min < std::size_t > (_recorded, telemetry_capacity); }
+		inline bool empty() const noexcept { return _recorded == 0; }
+
+		// cycles recorded since the last clear, held or not
+		inline uint64_t recorded() const noexcept { return _recorded; }
+
+		/// the n-th most recent cycle held, 0 being the last one
+		/// \note n must be lower than size()
+		inline cycle_stats const & recent(std::size_t n = 0) const noexcept {
+			return _cycles[(_recorded - 1 - n) % telemetry_capacity];
+		}
+
+		/// visit the cycles held, oldest first
+		template < typename _f >
+		void for_each(_f && visit) const {
+			for (auto i = _recorded - size(); i < _recorded; ++i) {
+				visit(_cycles[i % telemetry_capacity]);
+			}
+		}
+
+		/// pause at a percentile of the cycles held, nearest rank
+		/// \param percentile between 0 and 100
+		std::chrono::nanoseconds pause_percentile(double percentile) const {
+			if (empty())
+				return {};
+
+			std::vector < std::chrono::nanoseconds > pauses;
+			pauses.reserve(size());
+
+			for_each([&](cycle_stats const & stats) { pauses.push_back(stats.pause); });
+
+			auto const rank = static_cast < std::size_t > (std::ceil(percentile / 100.0 * static_cast < double > (pauses.size())));
+			auto const nth = pauses.begin() + static_cast < std::ptrdiff_t > (std::clamp < std::size_t > (rank, 1, pauses.size()) - 1);
+
+			std::nth_element(pauses.begin(), nth, pauses.end());
+
+			return *nth;
+		}
+
+		// forget the cycles held, cycle numbers keep counting
+		inline void clear() noexcept { _recorded = 0; }
+
+		// write every cycle recorded from now on as a line of json, nullptr turns the log off
+		inline void set_log(std::ostream * out) noexcept { _log = out; }
+
+	private:
+
+		static void write_json(std::ostream & out, cycle_stats const & stats) {
+			auto const us = [](std::chrono::nanoseconds t) { return std::chrono::duration < double, std::micro > (t).count(); };
+
+			out << "{\"cycle\":" << stats.cycle
+				<< ",\"kind\":\"" << to_string(stats.kind) << '"'
+				<< ",\"objects_before\":" << stats.objects_before
+				<< ",\"objects_after\":" << stats.objects_after
+				<< ",\"survivors\":" << stats.survivors
+				<< ",\"bytes_before\":" << stats.bytes_before
+				<< ",\"bytes_after\":" << stats.bytes_after
+				<< ",\"pages_recycled\":" << stats.pages_recycled
+				<< ",\"peak_gray\":" << stats.peak_gray
+				<< ",\"slices\":" << stats.slices
+				<< ",\"pause_us\":" << us(stats.pause)
+				<< ",\"mark_us\":" << us(stats.mark)
+				<< ",\"compress_us\":" << us(stats.compress)
+				<< ",\"sweep_us\":" << us(stats.sweep)
+				<< "}\n";
+		}
+
+		std::array < cycle_stats, telemetry_capacity >
+							_cycles {};
+		uint64_t			_recorded { 0 };
+		uint64_t			_next_cycle { 0 };
+
+		std::ostream *		_log { nullptr };
+	};
+
+	// destructors run by each allocation while finalizers are pending
+	constexpr std::size_t finalizer_batch = 32;
+
+	// nursery run handed to a mutator at a time, bigger objects are tenured
+	constexpr std::size_t tlab_capacity = 32 * 1024;
+
+	// table nodes a mutator takes from the pool at a time
+	constexpr std::size_t node_batch = 64;
+
+	// collector state owned by one registered thread, the allocation and barrier fast paths only touch this
+	struct alignas(64) mutator {
+		// cleared while parked at a safepoint or inside a safe region
+		std::atomic_bool			running { true };
+
+		// handles created on this thread are registered here
+		table_node *				root { nullptr };
+		table_node *				root_ref { nullptr };
+
+		tlab						buffer;
+		std::vector < table_node * >
+									nodes;
+
+		std::vector < table_node * >
+									remembered;
+		std::vector < field_ref * >	remembered_fields;
+	};
+
+	/// generational compacting collector
+	/// \tparam page_capacity size of each old generation page
+	/// \tparam nursery_capacity size of the bump allocated nursery
+	/// \note new objects are bump allocated in the nursery. A minor collection traces the nursery
+	///       from the roots and the remembered set only, promotes the survivors into the old pages and
+	///       resets the nursery in one go. Objects are moved on promotion, raw pointers into the heap
+	///       do not survive an allocation.
+	/// \note a full collection can also run incrementally through collect_step, marking is then
+	///       interleaved with the mutator and kept sound by an insertion barrier in reg_ref. the sweep
+	///       and compaction that follow run in slices as well, objects born meanwhile are tenured black
+	/// \note types described with GC_FIELDS are traced precisely, their gc_field members are read
+	///       straight from object memory
+	/// \note destructors of collected objects are deferred to a finalizer queue, see finalizer_queue
+	/// \note every thread that touches the collector is registered on first use and owns a slice of
+	///       the nursery (a tlab), a root node for its handles and a cache of table nodes, so allocation
+	///       and reference registration need no locking. collections stop every registered thread at a
+	///       safepoint first, threads poll at each allocation outside of constructors. a registered
+	///       thread that blocks without allocating must do so inside a safe region. handles are owned
+	///       by the thread that created them, and a single collector instance per type is supported.
+	/// \note statistics of every cycle are kept in a ring buffer, see stats() and telemetry
+	template<std::size_t page_capacity, std::size_t nursery_capacity = page_capacity / 4>
+	struct collector {
+	public:
+
+		collector() {
+			_table.get_root()->obj.flags = node_flags::root;
+		}
+
+		template<typename _t, typename ... _args_tv>
+		inline table_node *allocate(_args_tv &&... args) {
+			auto & self = this_mutator();
+			auto * prev_root = _active_root;
+
+			// objects under construction are never moved, so neither park nor finalize from within a constructor
+			if (!prev_root) {
+				safepoint(self);
+
+				// pay for pending destructors a batch at a time
+				if (_finalizers_pending.load(std::memory_order_relaxed))
+					run_finalizers(finalizer_batch);
+			}
+
+			auto * node = take_node(self);
+			auto * alloc = allocate_block(self, node, sizeof(_t));
+
+			// set destructor, trivially destructible types skip finalization entirely
+			alloc->destructor = destructor_of < _t > ();
+			alloc->node = node;
+
+			node->obj.ptr = alloc->begin();
+			node->obj.type = descriptor_of < _t > ();
+
+			_active_root = node;
+
+			new(alloc->begin()) _t(std::forward<_args_tv>(args)...);
+
+			_active_root = prev_root;
+
+			return node;
+		}
+
+		/// run destructors of collected objects
+		/// \param max_count maximum number of destructors to run
+		/// \return number of destructors that ran, 0 if another thread is running them
+		std::size_t run_finalizers(std::size_t max_count = std::numeric_limits < std::size_t >::max()) {
+			if (!_finalizer_lock.try_lock())
+				return 0;
+
+			auto const count = _finalizers.run(max_count, [this](finalizer_queue::entry const & e) {
+				_finalized.push_back(e.node);
+			});
+
+			// destructors may take the heap lock themselves, release their nodes in one go afterwards
+			{
+				std::scoped_lock lock { _heap_lock };
+
+				for (auto * node : _finalized) {
+					_table.rem_obj_node(node);
+				}
+			}
+
+			_finalized.clear();
+
+			if (_finalizers.empty())
+				_finalizers_pending.store(false, std::memory_order_relaxed);
+
+			_finalizer_lock.unlock();
+
+			return count;
+		}
+
+		inline std::size_t pending_finalizers() const noexcept { return _finalizers.size(); }
+
+		table_node *get_root() {
+			return _active_root ? _active_root : this_mutator().root;
+		}
+
+		table_node * reg_ref(table_node *from, table_node *to) {
+			auto & self = this_mutator();
+
+			// write barrier, old objects pointing into the nursery become roots of the next minor collection
+			if (!is_root(from) && is_young(to) && !is_young(from))
+				remember(self, from);
+
+			// insertion barrier, a new reference shades its target gray so no black object ever points
+			// to a white one. the roots are a table node as well, so root stores are covered too
+			if (_marking)
+				shade(to);
+
+			return _table.link_ref_node(from, to, take_node(self));
+		}
+
+		void del_ref(table_node *from, table_node *ref) {
+			_table.unlink_ref_node(from, ref);
+			give_node(this_mutator(), ref);
+		}
+
+		/// store into a traced field, the field must live inside a collected object
+		/// \note runs the same barriers as reg_ref without touching the table, a field in an old
+		///       object pointing into the nursery is remembered by address
+		void store_field(field_ref & field, table_node * to) {
+			if (to) {
+				if (is_young(to) && !_nursery.contains(reinterpret_cast < uint8_t const * > (&field)))
+					this_mutator().remembered_fields.push_back(&field);
+
+				if (_marking)
+					shade(to);
+			}
+
+			field.obj = to;
+		}
+
+		/// park the calling thread if a collection is waiting for it
+		inline void safepoint() {
+			safepoint(this_mutator());
+		}
+
+		/// the calling thread is about to block, collections go ahead without waiting for it
+		/// \note the thread must not touch the collector or any handle until leave_safe_region
+		void enter_safe_region() {
+			enter_safe_region(this_mutator());
+		}
+
+		void leave_safe_region() {
+			leave_safe_region(this_mutator());
+		}
+
+		void set_gc_threads(std::size_t thread_count) {
+			_workers.set_thread_count(thread_count);
+		}
+
+		/// collect the nursery only
+		/// \note every survivor is promoted, so the nursery and the remembered set are empty afterwards
+		/// \note while an incremental cycle is running the nursery is left untouched, it is evacuated
+		///       when the cycle completes
+		void collect_minor() {
+			stop_the_world([this] { collect_nursery(); });
+		}
+
+		/// collect the whole heap, nursery included
+		/// \note abandons a running incremental cycle that is still marking, one that is sweeping is finished first
+		void collect() {
+			stop_the_world([this] {
+				if (_marking)
+					abort_cycle();
+
+				if (_sweeping) {
+					slice_budget unbounded { stats_clock::time_point::max() };
+					sweep_step(unbounded);
+				}
+
+				begin_cycle(cycle_kind::full);
+
+				// mark
+				auto const start = stats_clock::now();
+
+				_marker.mark(_table, _workers);
+
+				_stats.mark = elapsed_since(start);
+				_stats.peak_gray = _marker.peak_gray();
+
+				sweep();
+			});
+		}
+
+		/// run one slice of an incremental full collection, a new cycle starts if none is running
+		/// \param budget time the slice may spend collecting
+		/// \return true if this slice completed the cycle
+		/// \note marking, compaction and sweep each resume where the previous slice left them, a slice
+		///       overruns its budget by at most a few dozen references worth of work plus the scan of
+		///       the last gray object, an object is never split across slices
+		/// \note every slice stops the registered threads, the barriers only run in between slices
+		bool collect_step(std::chrono::nanoseconds budget) {
+			bool completed = false;
+
+			stop_the_world([&] {
+				auto const start = stats_clock::now();
+
+				slice_budget slice { start + budget };
+
+				if (!is_collecting()) {
+					_marking = true;
+
+					begin_cycle(cycle_kind::incremental);
+
+					auto * root = _table.get_root();
+
+					_table.mark(root);
+					push_gray(root);
+				}
+
+				_stats_slice = true;
+
+				if (_marking) {
+					while (!_gray.empty()) {
+						auto * obj = _gray.back();
+						_gray.pop_back();
+
+						std::size_t visited = 0;
+
+						for_each_ref(obj, [&](table_node * to) {
+							++visited;
+
+							if (_table.try_mark(to))
+								push_gray(to);
+						});
+
+						// charged by references, roots and array fields can hold many of them
+						if (slice.expired(1 + visited)) {
+							_stats.mark += elapsed_since(start);
+							return;
+						}
+					}
+
+					_stats.mark += elapsed_since(start);
+
+					begin_sweep();
+				}
+
+				completed = sweep_step(slice);
+			});
+
+			return completed;
+		}
+
+		inline bool is_collecting() const noexcept { return _marking || _sweeping; }
+
+		/// statistics of the last collection cycles
+		/// \note not synchronized with collections, query it while no other thread can collect
+		inline telemetry & stats() noexcept { return _telemetry; }
+
+	private:
+
+		struct mutator_slot {
+			collector *	owner { nullptr };
+			mutator *	state { nullptr };
+
+			mutator_slot() = default;
+			mutator_slot(mutator_slot const &) = delete;
+			mutator_slot & operator=(mutator_slot const &) = delete;
+
+			~mutator_slot() {
+				if (owner)
+					owner->unregister_mutator(*state);
+			}
+		};
+
+		inline mutator & this_mutator() {
+			if (!_mutator) [[unlikely]]
+				register_mutator();
+
+			return *_mutator;
+		}
+
+		void register_mutator() {
+			// unregisters the thread on exit, kept apart from _mutator so the fast path needs no tls guard
+			static thread_local mutator_slot slot;
+
+			std::scoped_lock registry { _registry_lock };
+
+			auto & self = *_mutators.emplace_back(std::make_unique < mutator > ());
+
+			{
+				std::scoped_lock lock { _heap_lock };
+
+				// thread roots hang off the table root, marking reaches them like any other reference
+				self.root = _table.reserve_node();
+				self.root->obj.flags = node_flags::root;
+				self.root_ref = _table.add_ref_node(_table.get_root(), self.root);
+			}
+
+			slot.owner = this;
+			slot.state = &self;
+
+			_mutator = &self;
+		}
+
+		void unregister_mutator(mutator & self) {
+			// never hold up a collection while waiting for the registry
+			enter_safe_region(self);
+
+			std::scoped_lock registry { _registry_lock };
+
+			self.buffer.retire();
+
+			// the remembered set outlives the thread
+			_remembered.insert(_remembered.end(), self.remembered.begin(), self.remembered.end());
+			_remembered_fields.insert(_remembered_fields.end(), self.remembered_fields.begin(), self.remembered_fields.end());
+
+			{
+				std::scoped_lock lock { _heap_lock };
+
+				for (auto * node : self.nodes) {
+					_table.release_node(node);
+				}
+
+				// a root still holding handles stays reachable from the table root
+				if (self.root->obj.ref_chain.empty()) {
+					_table.rem_ref_node(_table.get_root(), self.root_ref);
+					_table.release_node(self.root);
+				}
+			}
+
+			std::erase_if(_mutators, [&](auto const & m) { return m.get() == &self; });
+
+			_mutator = nullptr;
+		}
+
+		inline void safepoint(mutator & self) {
+			if (_stop.load(std::memory_order_relaxed)) [[unlikely]]
+				park(self);
+		}
+
+		// wait for the running collection, running and _stop form a dekker pair with stop_the_world
+		void park(mutator & self) {
+			do {
+				self.running.store(false);
+				self.running.notify_all();
+
+				while (_stop.load())
+					_stop.wait(true);
+
+				self.running.store(true);
+			} while (_stop.load());
+		}
+
+		void enter_safe_region(mutator & self) {
+			self.running.store(false);
+			self.running.notify_all();
+		}
+
+		void leave_safe_region(mutator & self) {
+			self.running.store(true);
+
+			if (_stop.load())
+				park(self);
+		}
+
+		// run work with every other registered thread parked
+		template < typename _f >
+		void stop_the_world(_f && work) {
+			auto & self = this_mutator();
+
+			// a concurrent collection may be stopping the world while this thread waits for the registry
+			enter_safe_region(self);
+
+			{
+				std::scoped_lock registry { _registry_lock };
+
+				// the pause includes waiting for every thread to reach a safepoint
+				auto const stopped = stats_clock::now();
+
+				_stop.store(true);
+
+				for (auto & m : _mutators) {
+					if (m.get() == &self)
+						continue;
+
+					while (m->running.load())
+						m->running.wait(true);
+				}
+
+				// seal every tlab and gather the remembered sets
+				for (auto & m : _mutators) {
+					m->buffer.retire();
+
+					_remembered.insert(_remembered.end(), m->remembered.begin(), m->remembered.end());
+					_remembered_fields.insert(_remembered_fields.end(), m->remembered_fields.begin(), m->remembered_fields.end());
+
+					m->remembered.clear();
+					m->remembered_fields.clear();
+				}
+
+				work();
+
+				_cycles.fetch_add(1, std::memory_order_relaxed);
 
-			page (std::size_t capacity) :
-				_buffer_size { capacity },
-				_top_level { level_of (_buffer_size) },
-				_available_nodes { capacity / 32 / 2 },
-				_buffer{ new uint8_t [capacity] },
-				_free_levels { new memory::node_chain < header_node > [_top_level + 1] }
-			{
-				// clean up stuff 
-				for (int i = 0; i <= _top_level; ++i) {
-					_free_levels[i].head = nullptr;
+				bool const stats_slice = std::exchange(_stats_slice, false);
+
+				if (stats_slice) {
+					_stats.pause = std::max(_stats.pause, elapsed_since(stopped));
+					++_stats.slices;
 				}
-				// set starting header
-				auto * h = header::write (_buffer.get(), true, _top_level);
-				auto * node = _available_nodes.reserve();
 
-				_free_levels [_top_level].prepend (node);
+				_stop.store(false);
+				_stop.notify_all();
 
-				node->link (h);
+				// logging is left out of the pause
+				if (stats_slice && std::exchange(_stats_done, false))
+					_telemetry.record(_stats);
 			}
 
-			static inline std::size_t level_of (std::size_t length) {
-				return std::log2 (length) - std::log2 (32U); // min size
+			leave_safe_region(self);
+		}
+
+		inline table_node * take_node(mutator & self) {
+			if (self.nodes.empty()) [[unlikely]] {
+				std::scoped_lock lock { _heap_lock };
+
+				_table.take_nodes(node_batch, [&](table_node * node) { self.nodes.push_back(node); });
 			}
 
-			header * allocate (std::size_t len) {
-				// calculate block size
-				std::size_t block_size = next_pow_2 (len + sizeof (header));
+			auto * node = self.nodes.back();
+			self.nodes.pop_back();
 
-				auto expected_level = level_of (block_size);
-				auto level = expected_level;
+			// cached nodes come back dirty from del_ref
+			auto const slot = node->slot;
+			*node = {};
+			node->slot = slot;
 
-				// find smallest fitting free block
-				while (_free_levels[level].empty()) {
-					++level;
-					if (level > _top_level) throw std::runtime_error ("out of memory");
-				}
+			return node;
+		}
 
-				auto * h_free_node = _free_levels[level].head;
-				auto * h_node = h_free_node ->ptr;
+		inline void give_node(mutator & self, table_node * node) {
+			self.nodes.push_back(node);
 
-				register_as_used(h_node, expected_level);
-				
-				// split blocks until expected length
-				while (level > expected_level) {
-					// split node
-					// -- demote
-					--level;
-					
-					// set buddy info
-					auto * b = find_buddy(h_node, level);
-					register_as_free(b, level);
-				}
+			if (self.nodes.size() > 2 * node_batch) [[unlikely]] {
+				std::scoped_lock lock { _heap_lock };
 
-				return h_node;
+				for (std::size_t i = 0; i < node_batch; ++i) {
+					_table.release_node(self.nodes.back());
+					self.nodes.pop_back();
+				}
 			}
+		}
 
-			void free (header * h, node_chain < table_node > & objects) {
-				// coalescing nodes
-				uint8_t level = h->level;
+		inline void shade(table_node * obj) {
+			std::scoped_lock lock { _heap_lock };
 
-				if (level < _top_level) { // top level does not coalesce since its composed by a single node
+			if (_table.try_mark(obj))
+				push_gray(obj);
+		}
 
-					auto * buddy = find_buddy(h, level);
+		inline void push_gray(table_node * obj) {
+			_gray.push_back(obj);
+			_stats.peak_gray = std::max(_stats.peak_gray, _gray.size());
+		}
 
-					while (buddy->free && buddy->level == level) {
-						// merge block ( clean free node chain )
-						register_as_used (buddy, level);
+		// start the statistics of a new cycle, the stop the world section running it takes the pause
+		void begin_cycle(cycle_kind kind) {
+			_stats = {};
+			_stats.kind = kind;
 
-						// -- move to left most header
-						if (buddy < h)
-							h = buddy;
+			_stats_slice = true;
+			_stats_done = false;
+		}
 
-						// -- promote level
-						++level;
+		static inline bool is_root(table_node const * obj) noexcept {
+			return (obj->obj.flags & node_flags::root) != 0;
+		}
 
-						if (level == _top_level)
-							break;
+		// young collection, runs with the world stopped
+		void collect_nursery() {
 
-						buddy = find_buddy(h, level);
-					}
-				}
+			if (is_collecting())
+				return;
 
-				// release header
-				register_as_free (h, level);
-			}
+			begin_cycle(cycle_kind::minor);
 
-		private:
+			auto const old_objects = _table.object_count();
 
-			inline void register_as_used (header * h, uint8_t level) {
-				auto * free_node = reinterpret_cast <header_node *> (h->user_data);
-				
-				_free_levels [h->level].remove(free_node);
-				_available_nodes.release(free_node);
+			_stats.bytes_before = _paging.used_bytes() + _nursery.used();
 
-				h->free = false;
-				h->level = level;
-				h->user_data = nullptr;
+			std::vector<table_node *> black_nodes;
+			auto start = stats_clock::now();
+
+			// mark young objects reachable from the roots and from old objects that point into the nursery
+			for_each_ref(_table.get_root(), [&](table_node * to) {
+				if (is_root(to))
+					trace_young(to);
+				else
+					gray_young(to);
+			});
+
+			for (auto * obj : _remembered) {
+				trace_young(obj);
 			}
 
-			inline void register_as_free (header * h, uint8_t level) {
-				auto * free_node = _available_nodes.reserve();
-				_free_levels[level].prepend(free_node);
-
-				h->free = true;
-				h->level = level;
-				
-				free_node->link(h);
+			for (auto * field : _remembered_fields) {
+				if (field->obj)
+					gray_young(field->obj);
 			}
 
-			header * find_buddy (header * h, uint8_t level) {
-				check_break(level <= _top_level);
+			while (!_gray.empty()) {
+				auto * obj = _gray.back();
+				_gray.pop_back();
 
-				auto h_offset = reinterpret_cast < uint8_t * >(h) - _buffer.get();
-				auto b_offset = h_offset ^ (32U << level);
-
-				check_break(b_offset >= 0);
+				trace_young(obj);
+			}
 
-				header * b = reinterpret_cast <header *>(_buffer.get() + b_offset);
+			_stats.mark = elapsed_since(start);
+			start = stats_clock::now();
 
-				return b;
-			}
+			std::size_t young_objects = 0;
+			std::size_t promoted = 0;
 
-			std::size_t const 					_buffer_size;
-			std::size_t const					_top_level;
+			// promote or reclaim, young nodes join the sweep once they are old
+			for (auto * block_it = _nursery.begin(); block_it != _nursery.end(); block_it = block_it->next) {
+				auto * node = block_it->node;
 
-			memory::node_pool < header_node > 	_available_nodes; // (top level length / low level length / 2)
-			std::unique_ptr < uint8_t [] > 		_buffer;
+				if (!node)
+					continue;
 
-			std::unique_ptr < memory::node_chain < header_node > [] >
-												_free_levels;
-		};
+				++young_objects;
 
-	}
+				if (_table.is_marked(node)) {
+					auto alloc = _paging.move_allocated(block_it);
+					node->obj.ptr = alloc->begin();
 
-	struct table {
-	public:
+					_table.unmark(node);
+					_table.register_obj_node(node);
 
-		table() {
-			_root = _available_nodes.reserve ();
-		}
-		 
-		inline table_node * get_root() const { return _root; }
+					++promoted;
+				} else if (!finalize(block_it)) {
+					black_nodes.push_back(node);
+				}
+			}
 
-		table_node *add_obj_node() {
-			auto * node = _available_nodes.reserve ();
-			_objects.prepend(node);
+			_stats.compress = elapsed_since(start);
+			start = stats_clock::now();
 
-#ifdef GC_DIAGNOSTICS
-			for (auto & o: _objects) {
-				check_break(&o == node || o.obj.ptr);
-				check_break(&o == node || buddy::header::from_ptr(o.obj.ptr)->user_data);
+			for (auto obj_address : black_nodes) {
+				_table.rem_obj_node(obj_address);
 			}
-#endif
 
-			return node;
-		}
+			_nursery.reset();
+			forget_remembered();
 
-		table_node *add_ref_node(table_node *from_object, table_node *to_object) {
-			auto * node = _available_nodes.reserve();
+			_stats.sweep = elapsed_since(start);
 
-			from_object->obj.ref_chain.prepend(node);
-			node->ref.to = to_object;
+			_stats.objects_before = old_objects + young_objects;
+			_stats.objects_after = old_objects + promoted;
+			_stats.survivors = promoted;
+			_stats.bytes_after = _paging.used_bytes();
 
-			return node;
+			_stats_done = true;
 		}
 
-		void rem_obj_node(table_node *object) {
-			// -- clear refs --
-			// theoretically they should clear themselves but...
-			object->obj.ref_chain.clear([&](table_node * n) { _available_nodes.release (n); });
-			// remove object
-			_objects.remove(object);
-			_available_nodes.release(object);
+		inline bool is_young(table_node const * obj) const noexcept {
+			return _nursery.contains(obj->obj.ptr);
 		}
 
-		void rem_ref_node(table_node *from_object, table_node *ref) {
-			from_object->obj.ref_chain.remove (ref);
-			_available_nodes.release (ref);
+		void abort_cycle() {
+			_marking = false;
+			_gray.clear();
+			_table.clear_marks();
 		}
 
-		inline node_chain < table_node > & objects() { return _objects; }
-
-	private:
-		node_pool < table_node > 	_available_nodes 	{ 4096 };
-		node_chain < table_node > 	_objects 			{ nullptr };
-		table_node * 				_root 				{ nullptr };
-	};
+		// reclaim everything left unmarked, compact the old pages and evacuate the nursery
+		void sweep() {
 
-	template<std::size_t capacity>
-	struct page {
-	public:
+			std::vector<table_node *> black_nodes;
+			std::size_t young_objects = 0;
 
-		page_header *begin() { return reinterpret_cast < page_header * > (_buffer); }
+			_stats.objects_before = _table.object_count();
+			_stats.bytes_before = _paging.used_bytes() + _nursery.used();
 
-		page_header *end() { return reinterpret_cast < page_header * > (_offset); }
+			// sweep and compress
+			auto start = stats_clock::now();
 
-		page() = default;
+			_stats.pages_recycled = _paging.compress(_table, _workers, [this](page_header * block) { finalize(block); });
 
-		inline page(page &&p) noexcept {
-			this->swap(p);
-		}
+			_stats.compress = elapsed_since(start);
+			start = stats_clock::now();
 
-		inline page &operator=(page &&p) noexcept {
-			this->swap(p);
-			return *this;
-		}
+			// promote nursery survivors, young nodes are not part of the table sweep
+			for (auto * block_it = _nursery.begin(); block_it != _nursery.end(); block_it = block_it->next) {
+				auto * node = block_it->node;
 
-		~page() {
-			free(_buffer);
-		}
+				if (!node)
+					continue;
 
-		void swap(page &p) noexcept {
-			using std::swap;
-			swap(_buffer, p._buffer);
-			swap(_offset, p._offset);
-		}
+				++young_objects;
 
-		void reset() {
-			_offset = _buffer;
-		}
+				if (_table.is_marked(node)) {
+					auto alloc = _paging.move_allocated(block_it);
+					node->obj.ptr = alloc->begin();
 
-		bool has_capacity(page_length length) const noexcept {
-			return capacity > ((_offset - _buffer) + length);
-		}
+					_table.register_obj_node(node);
+				} else if (!finalize(block_it)) {
+					black_nodes.push_back(node);
+				}
+			}
 
-		bool empty() const noexcept {
-			return _offset == _buffer;
-		}
+			// find unmarked nodes and reset markers
+			_table.for_each_unmarked([&](table_node * obj) { black_nodes.push_back(obj); });
+			_table.clear_marks();
 
-		page_header *allocate(page_length length) {
-			auto *header = end();
+			for (auto obj_address : black_nodes) {
+				_table.rem_obj_node(obj_address);
+			}
 
-			length = align_length(length, 8);
+			_nursery.reset();
+			forget_remembered();
 
-			_offset += (length + sizeof(page_header));
+			_stats.sweep = elapsed_since(start);
 
-			header->next = end();
-			header->length = length;
+			_stats.objects_before += young_objects;
+			_stats.objects_after = _table.object_count();
+			_stats.survivors = _stats.objects_after;
+			_stats.bytes_after = _paging.used_bytes();
 
-			return header;
+			_stats_done = true;
 		}
 
-		page_header *move_allocated(page_header *header) {
-			auto alloc_header = allocate(header->length);
-
-			alloc_header->node = header->node;
-			alloc_header->destructor = header->destructor;
+		// marking is done, the sweep of an incremental cycle starts from here and runs in sweep_step
+		void begin_sweep() {
+			_marking = false;
+			_sweeping = true;
 
-			// alignment issues
-			std::copy(header->begin(), header->end(), alloc_header->begin());
+			_stats.objects_before = _table.object_count();
+			_stats.bytes_before = _paging.used_bytes() + _nursery.used();
 
-			return alloc_header;
+			_sweep_pages = _paging.begin_compress();
+			_sweep_block = _nursery.begin();
+			_sweep_word = 0;
 		}
 
-	private:
-		uint8_t *_buffer{
-			reinterpret_cast < uint8_t * > (malloc(capacity))
-		};
+		// compact the old pages, evacuate the nursery and release the dead nodes until the slice is over
+		// returns true once the cycle is done, the next call resumes where this one stopped
+		bool sweep_step(slice_budget & slice) {
+			auto start = stats_clock::now();
 
-		uint8_t *_offset{_buffer};
-	};
+			bool const compacted = _paging.compress_step(_table,
+				[&](std::size_t units) { return slice.expired(units); },
+				[this](page_header * block) { finalize(block); });
 
-	template<std::size_t page_size>
-	struct paging {
+			_stats.compress += elapsed_since(start);
 
-		using page_type = page<page_size>;
+			if (!compacted)
+				return false;
 
-		page_type work_page;
-		std::vector<page_type> pages;
+			start = stats_clock::now();
 
-		paging() {
-			// add active page
-			pages.emplace_back();
-		}
+			bool const swept = evacuate_step(slice) && release_step(slice);
 
-		page_header *allocate(page_length length) {
-			if (!pages.back().has_capacity(length)) {
-				pages.emplace_back();
-			}
+			_stats.sweep += elapsed_since(start);
 
-			auto alloc = pages.back().allocate(length);
+			if (!swept)
+				return false;
 
-			return alloc;
-		}
+			_table.clear_marks();
+			_nursery.reset();
+			forget_remembered();
 
-		void compress() {
+			_sweeping = false;
 
-			uint32_t recycle_page = 0;
-			work_page.reset();
+			_stats.pages_recycled = _sweep_pages > _paging.pages.size() ? _sweep_pages - _paging.pages.size() : 0;
+			_stats.objects_after = _table.object_count();
+			_stats.survivors = _stats.objects_after;
+			_stats.bytes_after = _paging.used_bytes();
 
-			// by nature, even if completely full
-			// the iterating page should always be one step
-			// ahead of the work_page
-			for (auto &page : pages) {
+			_stats_done = true;
 
-				if (page.empty())
-					continue;
+			return true;
+		}
 
-				auto *block_it = page.begin();
-				auto *block_end = page.end();
+		// promote nursery survivors, young nodes are not part of the table sweep
+		bool evacuate_step(slice_budget & slice) {
+			for (; _sweep_block != _nursery.end(); _sweep_block = _sweep_block->next) {
+				if (slice.expired(1 + _sweep_block->length / 256))
+					return false;
 
-				while (block_it != block_end) {
+				auto * node = _sweep_block->node;
 
-					// if work_page handles no more blocks
-					// swap with discarded page
-					if (!work_page.has_capacity(block_it->length)) {
-						std::swap(pages[recycle_page], work_page);
-						work_page.reset();
-						++recycle_page;
-					}
+				if (!node)
+					continue;
 
-					if (block_it->node->obj.flags.marked) {
-						// move from one page to another if marked
-						auto alloc = work_page.move_allocated(block_it);
-						// update new allocated address
-						// TODO: perhaps better if updated within the move_allocated function
-						block_it->node->obj.ptr = alloc->begin();
-					} else {
-						// delete object
-						block_it->dispose();
-					}
+				++_stats.objects_before;
 
-					block_it = block_it->next;
+				if (_table.is_marked(node)) {
+					auto alloc = _paging.move_allocated(_sweep_block);
+					node->obj.ptr = alloc->begin();
+
+					_table.register_obj_node(node);
+				} else if (!finalize(_sweep_block)) {
+					_table.rem_obj_node(node);
 				}
 			}
 
-			std::swap(pages[recycle_page], work_page);
-			//TODO: implement mechanism to recover pages
-			pages.resize(recycle_page + 1);
+			return true;
 		}
-	};
 
-	template<std::size_t page_capacity>
-	struct collector {
-	public:
+		// release unmarked nodes a bitmap word at a time
+		bool release_step(slice_budget & slice) {
+			for (auto const word_count = _table.slot_word_count(); _sweep_word < word_count; ) {
+				auto const released = _table.for_each_unmarked(_sweep_word, _sweep_word + 1, [this](table_node * obj) { _table.rem_obj_node(obj); });
 
-		template<typename _t, typename ... _args_tv>
-		inline table_node *allocate(_args_tv &&... args) {
-			auto * node = _table.add_obj_node();
-			auto alloc	= _paging.allocate(sizeof(_t));
+				++_sweep_word;
 
-			// set destructor
-			alloc->destructor = [](uint8_t *ptr) { reinterpret_cast < _t * >(ptr)->~_t(); };
-			alloc->node = node;
+				if (slice.expired(1 + released))
+					return false;
+			}
 
-			node->obj.ptr = alloc->begin();
+			return true;
+		}
 
-			auto *prev_root = _active_root;
-			_active_root = node;
+		// queue the destructor of a dead block, returns false when there is none to run
+		bool finalize(page_header * block) {
+			if (!block->destructor)
+				return false;
 
-			new(alloc->begin()) _t(std::forward<_args_tv>(args)...);
+			auto * node = block->node;
+			auto * copy = _finalizers.stash(block->begin(), block->length);
 
-			_active_root = prev_root;
+			node->obj.ptr = copy;
+			_table.detach_obj_node(node);
 
-			return node;
-		}
+			_finalizers.push({ node, block->destructor, copy });
+			_finalizers_pending.store(true, std::memory_order_relaxed);
 
-		table_node *get_root() const {
-			return _active_root ? _active_root : (_active_root = _table.get_root());
+			return true;
 		}
 
-		table_node * reg_ref(table_node *from, table_node *to) {
-			return _table.add_ref_node(from, to);
-		}
+		inline page_header * allocate_block(mutator & self, table_node * node, page_length length) {
+			// bump allocate in the thread's own buffer, objects born during an incremental cycle are tenured black
+			if (!is_collecting()) {
+				if (auto * block = self.buffer.allocate(length)) [[likely]]
+					return block;
+			}
 
-		void del_ref(table_node *from, table_node *ref) {
-				_table.rem_ref_node(from, ref);
+			return allocate_block_slow(self, node, length);
 		}
 
-		void collect() {
-
-			std::vector<table_node *> gray_nodes;
-			std::vector<table_node *> black_nodes;
+		page_header * allocate_block_slow(mutator & self, table_node * node, page_length length) {
+			std::size_t const size = align_length(length, 8) + sizeof(page_header);
 
-			black_nodes.push_back(_table.get_root());
+			for (;;) {
+				auto const cycle = _cycles.load(std::memory_order_relaxed);
 
-			// mark
-			while (!black_nodes.empty()) {
-				for (auto * node: black_nodes)
 				{
-					table_object & obj = node->obj;
+					std::scoped_lock lock { _heap_lock };
 
-					obj.flags.marked = true;
+					// start a new tlab
+					if (!is_collecting() && size <= tlab_capacity / 4) {
+						auto const run_length = std::min(tlab_capacity, _nursery.remaining());
+
+						if (run_length >= size + sizeof(page_header)) {
+							self.buffer.retire();
+							self.buffer.reset(_nursery.carve(run_length), run_length);
+							return self.buffer.allocate(length);
+						}
+					}
 
-					for (auto & ref : obj.ref_chain) {
-						auto * to = ref.ref.to;
+					// objects under construction are not reachable yet, so never collect from within a constructor.
+					// they, objects too big for a tlab and objects born during an incremental cycle are tenured straight away
+					if (_active_root != nullptr || is_collecting() || size > tlab_capacity / 4) {
+						_table.register_obj_node(node);
 
-						if (to->obj.flags.marked)
-							continue;
+						if (is_collecting())
+							_table.mark(node);
 
-						gray_nodes.push_back(to);
+						return _paging.allocate(length);
 					}
 				}
 
-				std::swap(gray_nodes, black_nodes);
-				gray_nodes.resize(0);
+				// nursery is full, unless another thread collected it in the meantime
+				stop_the_world([&] {
+					if (_cycles.load(std::memory_order_relaxed) == cycle)
+						collect_nursery();
+				});
 			}
+		}
 
-			// sweep and compress
-			_paging.compress();
-
-			black_nodes.resize(0);
+		inline void remember(mutator & self, table_node * obj) {
+			std::atomic_ref < uint8_t > flags { obj->obj.flags };
 
-			// reset markers and clear nodes
-			for (auto & obj : _table.objects()) {
+			// cheap check first, old objects tend to be stored into over and over
+			if ((flags.load(std::memory_order_relaxed) & node_flags::remembered) != 0)
+				return;
 
-				if (!obj.obj.flags.marked)
-					black_nodes.push_back(&obj);
+			if ((flags.fetch_or(node_flags::remembered, std::memory_order_relaxed) & node_flags::remembered) == 0)
+				self.remembered.push_back(obj);
+		}
 
-				obj.obj.flags.marked = false;
+		void forget_remembered() {
+			for (auto * obj : _remembered) {
+				obj->obj.flags &= static_cast < uint8_t > (~node_flags::remembered);
 			}
 
-			for (auto obj_address : black_nodes) {
-				_table.rem_obj_node(obj_address);
-			}
+			_remembered.clear();
+			_remembered_fields.clear();
+		}
+
+		// gray young objects referenced by obj, old objects are not traced
+		void trace_young(table_node * obj) {
+			for_each_ref(obj, [&](table_node * to) { gray_young(to); });
+		}
+
+		inline void gray_young(table_node * obj) {
+			if (is_young(obj) && _table.try_mark(obj))
+				push_gray(obj);
 		}
 
-	private:
 		static thread_local table_node *_active_root;
+		static thread_local mutator * _mutator;
 
+		page<nursery_capacity>
+				_nursery;
 		paging<page_capacity>
 				_paging;
 		table 	_table;
+		worker_pool
+				_workers;
+		parallel_marker
+				_marker;
+
+		std::vector < table_node * >
+				_remembered;
+		std::vector < field_ref * >
+				_remembered_fields;
+		std::vector < table_node * >
+				_gray;
+		bool	_marking { false };
+
+		// incremental sweep state, it follows marking
+		bool	_sweeping { false };
+		std::size_t
+				_sweep_pages { 0 };
+		page_header *
+				_sweep_block { nullptr };
+		std::size_t
+				_sweep_word { 0 };
+
+		finalizer_queue
+				_finalizers;
+		spin_mutex
+				_finalizer_lock;
+		std::vector < table_node * >
+				_finalized;
+		std::atomic_bool
+				_finalizers_pending { false };
+
+		// registered threads and the safepoint handshake
+		std::vector < std::unique_ptr < mutator > >
+				_mutators;
+		std::mutex
+				_registry_lock;
+		spin_mutex
+				_heap_lock;
+		std::atomic_bool
+				_stop { false };
+		std::atomic_uint64_t
+				_cycles { 0 };
+
+		// statistics of the running cycle, recorded once it is done
+		telemetry
+				_telemetry;
+		cycle_stats
+				_stats;
+		bool	_stats_slice { false };
+		bool	_stats_done { false };
 	};
 
-	template<std::size_t page_capacity>
-	thread_local table_node *collector<page_capacity>::_active_root = { nullptr };
+	template<std::size_t page_capacity, std::size_t nursery_capacity>
+	thread_local table_node *collector<page_capacity, nursery_capacity>::_active_root = { nullptr };
+
+	template<std::size_t page_capacity, std::size_t nursery_capacity>
+	thread_local mutator * collector<page_capacity, nursery_capacity>::_mutator = { nullptr };
 
 	template<std::size_t page_capacity>
 	struct collector_buddy {
@@ -754,13 +2814,12 @@ namespace memory {
 			auto * node = _table.add_obj_node();
 
 			// request memory pages for memory
-			auto * alloc = _page.allocate (sizeof (_t));
+			auto * alloc = _heap.allocate (sizeof (_t));
 
-			// set destructor
-			void (*destructor)(uint8_t *) = [](uint8_t *ptr) { reinterpret_cast < _t * >(ptr)->~_t(); };
-			alloc->user_data = (void *)destructor;
+			// set destructor, trivially destructible types skip finalization entirely
+			alloc->user_data = (void *)destructor_of < _t > ();
 
-			check_break(alloc->user_data);
+			check_break(!alloc->free);
 
 			// link allocation table with memory segment
 			node->obj.ptr = alloc->begin();
@@ -775,12 +2834,27 @@ namespace memory {
 			// pop root object stack
 			_active_root = prev_root;
 
-			check_break(buddy::header::from_ptr(node->obj.ptr)->user_data);
+			if (!prev_root && !_finalizers.empty())
+				run_finalizers(finalizer_batch);
+
+			check_break(!buddy::header::from_ptr(node->obj.ptr)->free);
 			return node;
 		}
 
+		/// run destructors of collected objects
+		/// \param max_count maximum number of destructors to run
+		/// \return number of destructors that ran
+		std::size_t run_finalizers(std::size_t max_count = std::numeric_limits < std::size_t >::max()) {
+			return _finalizers.run(max_count, [this](finalizer_queue::entry const & e) {
+				_table.rem_obj_node(e.node);
+				_heap.free(buddy::header::from_ptr(e.ptr));
+			});
+		}
+
+		inline std::size_t pending_finalizers() const noexcept { return _finalizers.size(); }
+
 		table_node *get_root() const {
-			return _active_root ? _active_root : (_active_root = _table.get_root());
+			return _active_root ? _active_root : _table.get_root();
 		}
 
 		table_node * reg_ref(table_node *from, table_node *to) {
@@ -791,43 +2865,35 @@ namespace memory {
 			_table.rem_ref_node(from, ref);
 		}
 
-		void collect() {
-			std::vector<table_node *> gray_nodes;
-			std::vector<table_node *> black_nodes;
-
-			black_nodes.push_back(_table.get_root());
+		void set_gc_threads(std::size_t thread_count) {
+			_workers.set_thread_count(thread_count);
+		}
 
-			// mark
-			while (!black_nodes.empty()) {
-				for (auto * node: black_nodes)
-				{
-					table_object & obj = node->obj;
+		inline std::size_t page_count() const noexcept { return _heap.page_count(); }
 
-					obj.flags.marked = true;
+		/// statistics of the last collection cycles
+		inline telemetry & stats() noexcept { return _telemetry; }
 
-					for (auto & ref : obj.ref_chain) {
-						auto * to = ref.ref.to;
+		void collect() {
+			std::vector<table_node *> black_nodes;
 
-						if (to->obj.flags.marked)
-							continue;
+			cycle_stats stats;
+			auto const start = stats_clock::now();
 
-						gray_nodes.push_back(to);
-					}
-				}
+			stats.objects_before = _table.object_count();
+			stats.bytes_before = _heap.used_bytes();
 
-				std::swap(gray_nodes, black_nodes);
-				gray_nodes.resize(0);
-			}
+			// mark
+			_marker.mark(_table, _workers);
 
-			black_nodes.resize(0);
+			stats.mark = elapsed_since(start);
+			stats.peak_gray = _marker.peak_gray();
 
-			// reset markers and clear nodes
-			for (auto & obj : _table.objects()) {
-				if (!obj.obj.flags.marked)
-					black_nodes.push_back(&obj);
+			auto const sweep_start = stats_clock::now();
 
-				obj.obj.flags.marked = false;
-			}
+			// find unmarked nodes and reset markers
+			_table.for_each_unmarked([&](table_node * obj) { black_nodes.push_back(obj); });
+			_table.clear_marks();
 
 			for (auto * obj_address : black_nodes) {
 #ifdef GC_DIAGNOSTICS
@@ -835,29 +2901,34 @@ namespace memory {
 #endif
 				// get header
 				auto * header = buddy::header::from_ptr(obj_address->obj.ptr);
-				// call destructor
-				check_break(header->user_data);
-				reinterpret_cast < void (*)(uint8_t * p) > (header->user_data)(header->begin());
+				check_break(!header->free);
+
+				// defer the destructor, the block and its node stay reserved until it ran
+				if (header->user_data) {
+					_table.detach_obj_node(obj_address);
+					_finalizers.push({ obj_address, reinterpret_cast < void (*)(uint8_t * p) > (header->user_data), header->begin() });
+					continue;
+				}
 
 				// remove node from table
 				_table.rem_obj_node(obj_address);
 
 				// dealocate from page
-				_page.free(header, _table.objects());
+				_heap.free(header);
 
 #ifdef GC_DIAGNOSTICS
 				{
 					bool has_deleted_header = false;
 					bool has_invalid_header = false;
 
-					for (auto &o : _table.objects()) {
-						auto *h = buddy::header::from_ptr(o.obj.ptr);
-						if (!h->user_data) {
+					_table.for_each_object([&](table_node * o) {
+						auto *h = buddy::header::from_ptr(o->obj.ptr);
+						if (h->free) {
 							has_invalid_header = true;
 						}
 
-						has_deleted_header |= (&o == obj_address);
-					}
+						has_deleted_header |= (o == obj_address);
+					});
 
 
 					if (has_invalid_header || has_deleted_header) {
@@ -870,15 +2941,15 @@ namespace memory {
 								  << " | level: " << (int) h->level
 								  << " -> " << h->user_data << std::endl << std::endl;
 
-						for (auto &o : _table.objects()) {
-							h = buddy::header::from_ptr(o.obj.ptr);
+						_table.for_each_object([&](table_node * o) {
+							h = buddy::header::from_ptr(o->obj.ptr);
 							std::cout
-								<< (void *) &o
-								<< " | prev: " << o.prev
-								<< " | next: " << o.next
+								<< (void *) o
+								<< " | prev: " << o->prev
+								<< " | next: " << o->next
 								<< " | level: " << (int) h->level
 								<< " -> " << h->user_data << std::endl;
-						}
+						});
 
 						if (has_deleted_header) {
 							std::cout << "delete failed for: " << (void *) obj_address;
@@ -890,14 +2961,34 @@ namespace memory {
 #endif
 			}
 
+			stats.pages_recycled = _heap.release_free_pages();
+			stats.sweep = elapsed_since(sweep_start);
+
+			// blocks waiting for their destructor are still taken
+			stats.objects_after = _table.object_count();
+			stats.survivors = stats.objects_after;
+			stats.bytes_after = _heap.used_bytes();
+
+			stats.slices = 1;
+			stats.pause = elapsed_since(start);
+
+			_telemetry.record(stats);
 		}
 
 	private:
 		static thread_local table_node *_active_root;
 
-		buddy::page
-				_page { page_capacity };
+		buddy::heap
+				_heap { page_capacity };
+		finalizer_queue
+				_finalizers;
 		table 	_table;
+		worker_pool
+				_workers;
+		parallel_marker
+				_marker;
+		telemetry
+				_telemetry;
 	};
 
 	template<std::size_t page_capacity>
@@ -905,10 +2996,53 @@ namespace memory {
 
 }
 
+// describe the gc_field members of a type, so the collector can trace it precisely
+// usage: GC_FIELDS(type, field_a, field_b) at global scope, array members are traced element by element
+#define GC_FIELD_SPAN(type, field) memory::make_field_span < decltype(type::field) > (offsetof(type, field))
+
+#define GC_FOR_EACH_1(m, t, a) m(t, a)
+#define GC_FOR_EACH_2(m, t, a, ...) m(t, a), GC_FOR_EACH_1(m, t, __VA_ARGS__)
+#define GC_FOR_EACH_3(m, t, a, ...) m(t, a), GC_FOR_EACH_2(m, t, __VA_ARGS__)
+#define GC_FOR_EACH_4(m, t, a, ...) m(t, a), GC_FOR_EACH_3(m, t, __VA_ARGS__)
+#define GC_FOR_EACH_5(m, t, a, ...) m(t, a), GC_FOR_EACH_4(m, t, __VA_ARGS__)
+#define GC_FOR_EACH_6(m, t, a, ...) m(t, a), GC_FOR_EACH_5(m, t, __VA_ARGS__)
+#define GC_FOR_EACH_7(m, t, a, ...) m(t, a), GC_FOR_EACH_6(m, t, __VA_ARGS__)
+#define GC_FOR_EACH_8(m, t, a, ...) m(t, a), GC_FOR_EACH_7(m, t, __VA_ARGS__)
+
+#define GC_FOR_EACH_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, name, ...) name
+#define GC_FOR_EACH(m, t, ...) \
+	GC_FOR_EACH_SELECT(__VA_ARGS__, GC_FOR_EACH_8, GC_FOR_EACH_7, GC_FOR_EACH_6, GC_FOR_EACH_5, \
+		GC_FOR_EACH_4, GC_FOR_EACH_3, GC_FOR_EACH_2, GC_FOR_EACH_1)(m, t, __VA_ARGS__)
+
+#define GC_FIELDS(type, ...) \
+	template <> struct memory::gc_layout < type > { \
+		static constexpr std::array fields { GC_FOR_EACH(GC_FIELD_SPAN, type, __VA_ARGS__) }; \
+	}
+
 using namespace memory::literals;
 memory::collector<8_mb> _gc_service;
 
-memory::collector_buddy<64_mb> _gc_buddy_service;
+memory::collector_buddy<8_mb> _gc_buddy_service;
+
+// GC_LOG=<path> writes every cycle of both services to path as json lines
+struct gc_log {
+	gc_log() {
+		if (auto const * path = std::getenv("GC_LOG")) {
+			_out.open(path);
+
+			_gc_service.stats().set_log(&_out);
+			_gc_buddy_service.stats().set_log(&_out);
+		}
+	}
+
+	~gc_log() {
+		_gc_service.stats().set_log(nullptr);
+		_gc_buddy_service.stats().set_log(nullptr);
+	}
+
+private:
+	std::ofstream _out;
+} _gc_log;
 
 template<typename _t>
 struct gc {
@@ -922,7 +3056,7 @@ public:
 
 	inline gc() = default;
 
-	template<typename _dt, typename = memory::concept::Assignable <_dt, _t> >
+	template<typename _dt, typename = memory::concepts::Assignable <_dt, _t> >
 	inline gc(
 		gc<_dt> const &v
 	) {
@@ -934,7 +3068,7 @@ public:
 	}
 
 	template<typename _dt,
-		typename = memory::concept::Assignable <_dt, _t>
+		typename = memory::concepts::Assignable <_dt, _t>
 	> inline gc &operator=(gc<_dt> const &v) {
 		copy(v);
 		return *this;
@@ -945,7 +3079,7 @@ public:
 		return *this;
 	}
 
-	template<typename _dt, typename = memory::concept::Assignable <_dt, _t> >
+	template<typename _dt, typename = memory::concepts::Assignable <_dt, _t> >
 	inline gc(
 		gc<_dt> && v
 	) {
@@ -957,7 +3091,7 @@ public:
 	}
 
 	template<typename _dt,
-		typename = memory::concept::Assignable <_dt, _t>
+		typename = memory::concepts::Assignable <_dt, _t>
 	> inline gc &operator=(gc<_dt> &&v) {
 		this->swap (v);
 		return *this;
@@ -975,7 +3109,7 @@ public:
 
 	template <
 	    typename _cast_t,
-	    typename = memory::concept::Assignable <_cast_t, _t>
+	    typename = memory::concepts::Assignable <_cast_t, _t>
 	>
 	inline gc < _cast_t > as () const {
 		return gc < _cast_t > { _obj };
@@ -987,10 +3121,29 @@ public:
 	template <typename>
 	friend struct gc;
 
+	template <typename>
+	friend struct gc_field;
+
 	template < typename _dt >
 	void swap (gc < _dt > & g) {
+		// references belong to the owner of each side, re-register instead of swapping them
+		if (_ref) {
+			_gc_service.del_ref(_root, _ref);
+			_ref = nullptr;
+		}
+
+		if (g._ref) {
+			_gc_service.del_ref(g._root, g._ref);
+			g._ref = nullptr;
+		}
+
 		std::swap (_obj, g._obj);
-		std::swap (_ref, g._ref);
+
+		if (_obj)
+			_ref = _gc_service.reg_ref(_root, _obj);
+
+		if (g._obj)
+			g._ref = _gc_service.reg_ref(g._root, g._obj);
 	}
 
 private:
@@ -1032,6 +3185,75 @@ inline gc<_t> gc_new(_args_tv &&... args) {
 	return gc<_t> {_gc_service.allocate<_t>(std::forward<_args_tv>(args)...)};
 }
 
+// scope in which the calling thread blocks, joins or sleeps without holding up collections
+// handles must not be touched until the scope ends
+struct gc_safe_region {
+	inline gc_safe_region() { _gc_service.enter_safe_region(); }
+	inline ~gc_safe_region() { _gc_service.leave_safe_region(); }
+
+	gc_safe_region(gc_safe_region const &) = delete;
+	gc_safe_region & operator=(gc_safe_region const &) = delete;
+};
+
+// traced member reference, costs a pointer and registers nothing
+// only valid as a member of a collected type listed with GC_FIELDS, locals and
+// anything outside the collected heap keep using gc
+template<typename _t>
+struct gc_field : memory::field_ref {
+public:
+
+	inline _t *operator->() const noexcept { return get(); }
+
+	inline explicit operator bool() const noexcept {
+		return obj != nullptr;
+	}
+
+	inline gc_field() = default;
+
+	inline gc_field(gc_field const & v) {
+		_gc_service.store_field(*this, v.obj);
+	}
+
+	template<typename _dt, typename = memory::concepts::Assignable <_dt, _t> >
+	inline gc_field(gc<_dt> const & v) {
+		_gc_service.store_field(*this, v._obj);
+	}
+
+	inline gc_field &operator=(gc_field const & v) {
+		_gc_service.store_field(*this, v.obj);
+		return *this;
+	}
+
+	template<typename _dt, typename = memory::concepts::Assignable <_dt, _t> >
+	inline gc_field &operator=(gc<_dt> const & v) {
+		_gc_service.store_field(*this, v._obj);
+		return *this;
+	}
+
+	inline gc_field &operator=(std::nullptr_t) noexcept {
+		obj = nullptr;
+		return *this;
+	}
+
+	// root handle to the referenced object
+	inline gc<_t> load() const {
+		return obj ? gc<_t> { obj } : gc<_t> {};
+	}
+
+	inline operator gc<_t>() const {
+		return load();
+	}
+
+private:
+
+	inline _t *get() const noexcept {
+		if (obj)
+			return reinterpret_cast < _t *> (obj->obj.ptr);
+		else
+			return nullptr;
+	}
+};
+
 template<typename _t>
 struct gc_buddy {
 public:
@@ -1044,7 +3266,7 @@ public:
 
 	inline gc_buddy() = default;
 
-	template<typename _dt, typename = memory::concept::Assignable <_dt, _t> >
+	template<typename _dt, typename = memory::concepts::Assignable <_dt, _t> >
 	inline gc_buddy(
 		gc_buddy<_dt> const &v
 	) {
@@ -1056,7 +3278,7 @@ public:
 	}
 
 	template<typename _dt,
-		typename = memory::concept::Assignable <_dt, _t>
+		typename = memory::concepts::Assignable <_dt, _t>
 	> inline gc_buddy &operator=(gc_buddy<_dt> const &v) {
 		copy(v);
 		return *this;
@@ -1067,7 +3289,7 @@ public:
 		return *this;
 	}
 
-	template<typename _dt, typename = memory::concept::Assignable <_dt, _t> >
+	template<typename _dt, typename = memory::concepts::Assignable <_dt, _t> >
 	inline gc_buddy(
 		gc<_dt> && v
 	) {
@@ -1079,7 +3301,7 @@ public:
 	}
 
 	template<typename _dt,
-		typename = memory::concept::Assignable <_dt, _t>
+		typename = memory::concepts::Assignable <_dt, _t>
 	> inline gc_buddy &operator=(gc<_dt> &&v) {
 		this->swap (v);
 		return *this;
@@ -1097,7 +3319,7 @@ public:
 
 	template <
 		typename _cast_t,
-		typename = memory::concept::Assignable <_cast_t, _t>
+		typename = memory::concepts::Assignable <_cast_t, _t>
 	>
 	inline gc_buddy < _cast_t > as () const {
 		return gc_buddy < _cast_t > { _obj };
@@ -1181,35 +3403,95 @@ inline gc_buddy<_t> gc_buddy_new (_args_tv &&... args) {
 
 constexpr uint32_t object_size = 16;//1_kb;
 
+// pause percentiles of the cycles recorded since the last stats().clear(), next to the throughput
+template < typename _service_t >
+void report_pauses(benchmark::State &state, _service_t & service) {
+	auto const & stats = service.stats();
+
+	state.counters["p50_pause_us"] = std::chrono::duration < double, std::micro > (stats.pause_percentile(50)).count();
+	state.counters["p99_pause_us"] = std::chrono::duration < double, std::micro > (stats.pause_percentile(99)).count();
+}
+
 struct demo {
 	uint8_t xxx[object_size];
 	gc<demo> to;
 };
 
-void gc_alloc_assign(benchmark::State &state) {
+template < typename _demo_t >
+void gc_alloc_assign_of(benchmark::State &state) {
 
-	auto root = gc_new<demo>();
+	auto root = gc_new<_demo_t>();
 	auto node = root;
 
+	_gc_service.stats().clear();
+
 	for (auto _ : state) {
 
 		for (std::size_t i = 0; i < state.range(0); ++i) {
-			node->to = gc_new < demo > ();
+			node->to = gc_new < _demo_t > ();
 		}
 
 		state.PauseTiming();
 		_gc_service.collect();
 		state.ResumeTiming();
 	}
+
+	report_pauses(state, _gc_service);
+}
+
+// same shape as demo, traced through its type descriptor instead of registered references
+struct demo_traced {
+	uint8_t xxx[object_size];
+	gc_field<demo_traced> to;
+};
+
+GC_FIELDS(demo_traced, to);
+
+void gc_alloc_assign(benchmark::State &state) {
+	gc_alloc_assign_of < demo > (state);
+}
+
+void gc_alloc_assign_traced(benchmark::State &state) {
+	gc_alloc_assign_of < demo_traced > (state);
 }
 
 BENCHMARK(gc_alloc_assign)->Range(1 << 8, 1 << 18);
+BENCHMARK(gc_alloc_assign_traced)->Range(1 << 8, 1 << 18);
+
+// reference creation alone, the same two objects are stored over and over
+template < typename _demo_t >
+void gc_assign_of(benchmark::State &state) {
+	auto node = gc_new<_demo_t>();
+	gc<_demo_t> targets[2] { gc_new<_demo_t>(), gc_new<_demo_t>() };
+
+	for (auto _ : state) {
+		for (std::size_t i = 0; i < state.range(0); ++i) {
+			node->to = targets[i & 1U];
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void gc_assign(benchmark::State &state) {
+	gc_assign_of < demo > (state);
+}
+
+void gc_assign_traced(benchmark::State &state) {
+	gc_assign_of < demo_traced > (state);
+}
+
+BENCHMARK(gc_assign)->Range(1 << 8, 1 << 18);
+BENCHMARK(gc_assign_traced)->Range(1 << 8, 1 << 18);
 
 void gc_collect(benchmark::State &state) {
+	_gc_service.set_gc_threads(state.range(1));
 
 	auto root = gc_new<demo>();
 	auto node = root;
 
+	_gc_service.stats().clear();
+
 	for (auto _ : state) {
 		state.PauseTiming();
 
@@ -1221,9 +3503,426 @@ void gc_collect(benchmark::State &state) {
 
 		_gc_service.collect();
 	}
+
+	report_pauses(state, _gc_service);
+
+	_gc_service.set_gc_threads(1);
+}
+
+#define GC_THREAD_SWEEP { 1, 2, 4, 8 }
+
+BENCHMARK(gc_collect)
+	->ArgsProduct({ benchmark::CreateRange(1 << 8, 1 << 18, 8), GC_THREAD_SWEEP })
+	->ArgNames({ "objects", "threads" })
+	->UseRealTime();
+
+// every mutator allocates from its own tlab and rewires its own chain, the nursery filling up stops all of them
+void gc_alloc_assign_mutators(benchmark::State &state) {
+	auto const mutators = static_cast < std::size_t > (state.range(0));
+	auto const objects = static_cast < std::size_t > (state.range(1));
+
+	_gc_service.stats().clear();
+
+	for (auto _ : state) {
+		std::atomic_bool go { false };
+		std::vector < std::thread > threads;
+
+		for (std::size_t t = 0; t < mutators; ++t) {
+			threads.emplace_back([&] {
+				while (!go.load(std::memory_order_acquire))
+					_mm_pause();
+
+				auto root = gc_new<demo>();
+				auto node = root;
+
+				for (std::size_t i = 0; i < objects; ++i) {
+					node->to = gc_new < demo > ();
+				}
+			});
+		}
+
+		// the benchmark thread only joins, collections must not wait for it
+		gc_safe_region region;
+
+		go.store(true, std::memory_order_release);
+
+		for (auto & thread : threads) {
+			thread.join();
+		}
+	}
+
+	state.SetItemsProcessed(static_cast < int64_t > (state.iterations() * mutators * objects));
+	report_pauses(state, _gc_service);
+}
+
+BENCHMARK(gc_alloc_assign_mutators)
+	->ArgsProduct({ GC_THREAD_SWEEP, { 1 << 12, 1 << 16 } })
+	->ArgNames({ "mutators", "objects" })
+	->UseRealTime();
+
+constexpr std::size_t tree_arity = 4;
+
+struct demo_tree {
+	uint8_t xxx[object_size];
+	gc<demo_tree> children[tree_arity];
+};
+
+struct demo_tree_traced {
+	uint8_t xxx[object_size];
+	gc_field<demo_tree_traced> children[tree_arity];
+};
+
+GC_FIELDS(demo_tree_traced, children);
+
+// grow a complete tree of object_count nodes under root, returns the handles in breadth first order
+// handles are kept instead of raw pointers, allocations may promote and move objects
+template < typename _tree_t >
+std::vector<gc<_tree_t>> build_tree(gc<_tree_t> root, std::size_t object_count) {
+	std::vector<gc<_tree_t>> nodes { root };
+	nodes.reserve(object_count);
+
+	for (std::size_t i = 1; i < object_count; ++i) {
+		auto child = gc_new<_tree_t>();
+
+		nodes[(i - 1) / tree_arity]->children[(i - 1) % tree_arity] = child;
+		nodes.push_back(child);
+	}
+
+	return nodes;
+}
+
+// every object stays reachable, so the mark phase has to trace the whole heap
+template < typename _tree_t >
+void gc_collect_live_of(benchmark::State &state) {
+	_gc_service.set_gc_threads(state.range(1));
+
+	auto root = gc_new<_tree_t>();
+
+	build_tree(root, static_cast < std::size_t > (state.range(0)));
+
+	_gc_service.stats().clear();
+
+	for (auto _ : state) {
+		_gc_service.collect();
+	}
+
+	report_pauses(state, _gc_service);
+
+	_gc_service.set_gc_threads(1);
+}
+
+void gc_collect_live(benchmark::State &state) {
+	gc_collect_live_of < demo_tree > (state);
+}
+
+void gc_collect_live_traced(benchmark::State &state) {
+	gc_collect_live_of < demo_tree_traced > (state);
+}
+
+BENCHMARK(gc_collect_live)
+	->ArgsProduct({ benchmark::CreateRange(1 << 8, 1 << 18, 8), GC_THREAD_SWEEP })
+	->ArgNames({ "objects", "threads" })
+	->UseRealTime();
+
+BENCHMARK(gc_collect_live_traced)
+	->ArgsProduct({ benchmark::CreateRange(1 << 8, 1 << 18, 8), GC_THREAD_SWEEP })
+	->ArgNames({ "objects", "threads" })
+	->UseRealTime();
+
+// half of the heap survives, half is garbage, so both the mark and the sweep scan carry weight
+void gc_collect_mixed(benchmark::State &state) {
+	auto const objects = static_cast < std::size_t > (state.range(0));
+
+	_gc_service.set_gc_threads(state.range(1));
+
+	auto root = gc_new<demo_tree>();
+
+	build_tree(root, objects / 2);
+
+	_gc_service.stats().clear();
+
+	for (auto _ : state) {
+		state.PauseTiming();
+
+		for (std::size_t i = 0; i < objects / 2; ++i) {
+			gc_new<demo_tree>();
+		}
+
+		state.ResumeTiming();
+
+		_gc_service.collect();
+	}
+
+	report_pauses(state, _gc_service);
+
+	_gc_service.set_gc_threads(1);
+}
+
+BENCHMARK(gc_collect_mixed)
+	->ArgsProduct({ benchmark::CreateRange(1 << 8, 1 << 18, 8), GC_THREAD_SWEEP })
+	->ArgNames({ "objects", "threads" })
+	->UseRealTime();
+
+// every other old object dies between collections, so compaction has to slide half of every page
+void gc_compact_fragmented(benchmark::State &state) {
+	auto const objects = static_cast < std::size_t > (state.range(0));
+
+	_gc_service.set_gc_threads(state.range(1));
+
+	std::vector<gc<demo>> live;
+	live.reserve(objects);
+
+	for (std::size_t i = 0; i < objects; ++i) {
+		live.push_back(gc_new<demo>());
+	}
+
+	_gc_service.collect();
+	_gc_service.stats().clear();
+
+	for (auto _ : state) {
+		state.PauseTiming();
+
+		for (std::size_t i = 1; i < objects; i += 2) {
+			live[i] = gc_new<demo>();
+		}
+
+		state.ResumeTiming();
+
+		_gc_service.collect();
+	}
+
+	report_pauses(state, _gc_service);
+
+	_gc_service.set_gc_threads(1);
+}
+
+BENCHMARK(gc_compact_fragmented)
+	->ArgsProduct({ { 1 << 14, 1 << 16, 1 << 18 }, GC_THREAD_SWEEP })
+	->ArgNames({ "objects", "threads" })
+	->UseRealTime();
+
+// owns a buffer, so its destructor has real work to do
+struct demo_finalized {
+	std::unique_ptr < uint8_t [] > buffer { new uint8_t [object_size * 8] };
+	gc<demo_finalized> to;
+};
+
+// every object dies between collections, the measured pause either leaves the destructors to the
+// finalizer queue or drains it right away like an inline sweep would
+template < bool deferred >
+void gc_collect_finalized(benchmark::State &state) {
+	auto const objects = static_cast < std::size_t > (state.range(0));
+
+	_gc_service.stats().clear();
+
+	for (auto _ : state) {
+		state.PauseTiming();
+
+		for (std::size_t i = 0; i < objects; ++i) {
+			gc_new<demo_finalized>();
+		}
+
+		_gc_service.run_finalizers();
+
+		state.ResumeTiming();
+
+		_gc_service.collect();
+
+		if constexpr (!deferred)
+			_gc_service.run_finalizers();
+	}
+
+	_gc_service.run_finalizers();
+
+	report_pauses(state, _gc_service);
+}
+
+void gc_collect_finalized_deferred(benchmark::State &state) {
+	gc_collect_finalized < true > (state);
+}
+
+void gc_collect_finalized_inline(benchmark::State &state) {
+	gc_collect_finalized < false > (state);
+}
+
+BENCHMARK(gc_collect_finalized_deferred)
+	->RangeMultiplier(8)->Range(1 << 8, 1 << 17)
+	->ArgName("objects")
+	->UseRealTime();
+
+BENCHMARK(gc_collect_finalized_inline)
+	->RangeMultiplier(8)->Range(1 << 8, 1 << 17)
+	->ArgName("objects")
+	->UseRealTime();
+
+// larger than a finalizer queue chunk, its copy gets a chunk of its own
+struct demo_finalized_large {
+	static constexpr uint8_t pattern = 0x5a;
+
+	static inline std::size_t corrupted { 0 };
+
+	demo_finalized_large() { payload.fill(pattern); }
+
+	~demo_finalized_large() {
+		if (std::ranges::any_of(payload, [](uint8_t b) { return b != pattern; }))
+			++corrupted;
+	}
+
+	std::array < uint8_t, 96 * 1024 > payload;
+};
+
+// a small copy leaves a regular chunk in the queue, a large one adds an oversized chunk, once drained
+// the queue keeps a single chunk and the next large copy has to fit in it
+void gc_collect_finalized_large(benchmark::State &state) {
+	demo_finalized_large::corrupted = 0;
+
+	for (auto _ : state) {
+		gc_new<demo_finalized>();
+		_gc_service.collect();
+
+		gc_new<demo_finalized_large>();
+		_gc_service.collect();
+		_gc_service.run_finalizers();
+
+		gc_new<demo_finalized_large>();
+		_gc_service.collect();
+		_gc_service.run_finalizers();
+	}
+
+	if (demo_finalized_large::corrupted != 0)
+		state.SkipWithError("finalized copy corrupted");
+}
+
+BENCHMARK(gc_collect_finalized_large)
+	->UseRealTime();
+
+constexpr std::size_t young_objects = 1 << 12;
+constexpr std::size_t young_survivors = 64;
+
+// old tree of state.range(0) objects plus a batch of young objects, a few of them stored into old
+// leaves through the write barrier, then a single collection which is the measured pause
+template < bool minor >
+void gc_collect_generation(benchmark::State &state) {
+	auto root = gc_new<demo_tree>();
+	auto nodes = build_tree(root, static_cast < std::size_t > (state.range(0)));
+
+	// leaves hold the survivors, the remaining handles are dropped so the tree is only reachable from root
+	std::vector<gc<demo_tree>> leaves (nodes.end() - std::min(nodes.size(), young_survivors), nodes.end());
+	nodes.clear();
+
+	_gc_service.collect();
+	_gc_service.stats().clear();
+
+	for (auto _ : state) {
+		state.PauseTiming();
+
+		for (std::size_t i = 0; i < young_objects; ++i) {
+			auto young = gc_new<demo_tree>();
+
+			if (i % (young_objects / young_survivors) == 0)
+				leaves[(i / (young_objects / young_survivors)) % leaves.size()]->children[0] = young;
+		}
+
+		state.ResumeTiming();
+
+		if constexpr (minor)
+			_gc_service.collect_minor();
+		else
+			_gc_service.collect();
+	}
+
+	report_pauses(state, _gc_service);
+}
+
+void gc_collect_minor(benchmark::State &state) {
+	gc_collect_generation < true > (state);
+}
+
+void gc_collect_full(benchmark::State &state) {
+	gc_collect_generation < false > (state);
+}
+
+BENCHMARK(gc_collect_minor)->Range(1 << 8, 1 << 18)->ArgName("old_objects")->UseRealTime();
+BENCHMARK(gc_collect_full)->Range(1 << 8, 1 << 18)->ArgName("old_objects")->UseRealTime();
+
+constexpr std::size_t mutator_batches = 32;
+constexpr std::size_t mutator_batch_size = 128;
+
+// mutator allocating and rewiring live objects over a live tree of state.range(0) objects, each iteration
+// runs at least mutator_batches batches and exactly one complete full collection. the incremental variant runs
+// a slice of state.range(1) microseconds after every batch until the cycle completes, the stop the world
+// variant collects once at the end
+template < bool incremental >
+void gc_mutator_pause(benchmark::State &state) {
+	using clock = std::chrono::steady_clock;
+
+	auto const budget = std::chrono::microseconds(incremental ? state.range(1) : 0);
+
+	auto root = gc_new<demo_tree>();
+	auto nodes = build_tree(root, static_cast < std::size_t > (state.range(0)));
+
+	std::vector<gc<demo_tree>> leaves (nodes.end() - std::min(nodes.size(), young_survivors), nodes.end());
+	nodes.clear();
+
+	_gc_service.collect();
+	_gc_service.stats().clear();
+
+	std::size_t allocations = 0;
+	std::size_t slices = 0;
+	clock::duration max_pause {};
+
+	for (auto _ : state) {
+		bool cycle_done = false;
+
+		for (std::size_t batch = 0; batch < mutator_batches || !cycle_done; ++batch) {
+			for (std::size_t i = 0; i < mutator_batch_size; ++i, ++allocations) {
+				auto young = gc_new<demo_tree>();
+				leaves[allocations % leaves.size()]->children[allocations % tree_arity] = young;
+			}
+
+			if (incremental ? !cycle_done : batch + 1 == mutator_batches) {
+				auto const start = clock::now();
+
+				if constexpr (incremental) {
+					cycle_done |= _gc_service.collect_step(budget);
+				} else {
+					_gc_service.collect();
+					cycle_done = true;
+				}
+
+				max_pause = std::max(max_pause, clock::now() - start);
+				++slices;
+			}
+		}
+	}
+
+	report_pauses(state, _gc_service);
+
+	// leave no cycle running for the next benchmark
+	_gc_service.collect();
+
+	state.SetItemsProcessed(static_cast < int64_t > (allocations));
+	state.counters["max_pause_us"] = std::chrono::duration < double, std::micro > (max_pause).count();
+	state.counters["slices"] = benchmark::Counter(static_cast < double > (slices), benchmark::Counter::kAvgIterations);
+}
+
+void gc_mutator_pause_incremental(benchmark::State &state) {
+	gc_mutator_pause < true > (state);
 }
 
-BENCHMARK(gc_collect)->Range(1 << 8, 1 << 18);
+void gc_mutator_pause_stop_the_world(benchmark::State &state) {
+	gc_mutator_pause < false > (state);
+}
+
+BENCHMARK(gc_mutator_pause_incremental)
+	->ArgsProduct({ { 1 << 14, 1 << 16, 1 << 18 }, { 100, 1000 } })
+	->ArgNames({ "objects", "budget_us" })
+	->UseRealTime();
+
+BENCHMARK(gc_mutator_pause_stop_the_world)
+	->Arg(1 << 14)->Arg(1 << 16)->Arg(1 << 18)
+	->ArgName("objects")
+	->UseRealTime();
 
 
 struct demo_buddy {
@@ -1235,6 +3934,10 @@ void gc_buddy_assign(benchmark::State &state) {
 	auto root = gc_buddy_new<demo_buddy>();
 	auto node = root;
 
+	std::size_t max_pages = 0;
+
+	_gc_buddy_service.stats().clear();
+
 	for (auto _ : state) {
 
 		for (std::size_t i = 0; i < state.range(0); ++i) {
@@ -1242,9 +3945,13 @@ void gc_buddy_assign(benchmark::State &state) {
 		}
 
 		state.PauseTiming();
+		max_pages = std::max(max_pages, _gc_buddy_service.page_count());
 		_gc_buddy_service.collect();
 		state.ResumeTiming();
 	}
+
+	state.counters["pages"] = static_cast < double > (max_pages);
+	report_pauses(state, _gc_buddy_service);
 }
 
 BENCHMARK(gc_buddy_assign)->Range(1 << 8, 1 << 18);
@@ -1253,6 +3960,8 @@ void gc_buddy_collect(benchmark::State &state) {
 	auto root = gc_buddy_new<demo_buddy>();
 	auto node = root;
 
+	_gc_buddy_service.stats().clear();
+
 	for (auto _ : state) {
 
 		state.PauseTiming();
@@ -1263,6 +3972,8 @@ void gc_buddy_collect(benchmark::State &state) {
 
 		_gc_buddy_service.collect();
 	}
+
+	report_pauses(state, _gc_buddy_service);
 }
 
 BENCHMARK(gc_buddy_collect)->Range(1 << 8, 1 << 18);
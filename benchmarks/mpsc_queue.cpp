@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <xmmintrin.h>
+#include <lockfree_queue.h>
+#include <lockfree_stack.h>
+
+// message as delivered through the intrusive mpsc queue
+struct queue_message : lf::mpsc_link {
+	uint64_t producer;
+	uint64_t sequence;
+};
+
+// message as stored by value in the lock free stack
+struct stack_message {
+	uint64_t producer;
+	uint64_t sequence;
+};
+
+/// validate that messages from the same producer arrive in order
+struct fifo_checker {
+
+	explicit fifo_checker (std::size_t producer_count) :
+		_expected (producer_count, 0) {}
+
+	void consume (uint64_t producer, uint64_t sequence) {
+		if (_expected [producer] != sequence) {
+			++_out_of_order;
+		}
+
+		_expected [producer] = sequence + 1;
+	}
+
+	[[nodiscard]] std::size_t out_of_order () const { return _out_of_order; }
+
+private:
+	std::vector < uint64_t >	_expected;
+	std::size_t					_out_of_order { 0 };
+};
+
+template < typename message_t >
+std::vector < message_t > make_messages (std::size_t producer_count, std::size_t message_count) {
+	std::vector < message_t > messages (producer_count * message_count);
+
+	for (std::size_t p = 0; p < producer_count; ++p) {
+		for (std::size_t i = 0; i < message_count; ++i) {
+			auto & msg = messages [p * message_count + i];
+
+			msg.producer = p;
+			msg.sequence = i;
+		}
+	}
+
+	return messages;
+}
+
+// every thread gets its own copy of producer, callers pass temporaries that are gone once this returns
+template < typename producer_f >
+std::vector < std::thread > launch_producers (std::size_t producer_count, std::atomic_bool & go, producer_f producer) {
+	std::vector < std::thread > producers;
+	producers.reserve (producer_count);
+
+	for (std::size_t p = 0; p < producer_count; ++p) {
+		producers.emplace_back ([producer, &go, p] {
+			while (!go.load (std::memory_order_acquire)) {
+				_mm_pause ();
+			}
+
+			producer (p);
+		});
+	}
+
+	return producers;
+}
+
+void mpsc_queue_fifo (benchmark::State & state) {
+	auto const PRODUCERS = static_cast < std::size_t > (state.range (0));
+	auto const MESSAGES = static_cast < std::size_t > (state.range (1));
+	auto const TOTAL = PRODUCERS * MESSAGES;
+
+	auto messages = make_messages < queue_message > (PRODUCERS, MESSAGES);
+	std::size_t out_of_order = 0;
+
+	for (auto _ : state) {
+		lf::mpsc_queue < queue_message > queue;
+		fifo_checker checker { PRODUCERS };
+		std::atomic_bool go { false };
+
+		auto producers = launch_producers (PRODUCERS, go, [&](std::size_t p) {
+			for (std::size_t i = 0; i < MESSAGES; ++i) {
+				queue.push (&messages [p * MESSAGES + i]);
+			}
+		});
+
+		go.store (true, std::memory_order_release);
+
+		// consume
+		std::size_t received = 0;
+
+		while (received < TOTAL) {
+			if (auto * msg = queue.pop ()) {
+				checker.consume (msg->producer, msg->sequence);
+				++received;
+			} else {
+				_mm_pause ();
+			}
+		}
+
+		for (auto & producer : producers) {
+			producer.join ();
+		}
+
+		out_of_order += checker.out_of_order ();
+	}
+
+	state.SetItemsProcessed (static_cast < int64_t > (state.iterations () * TOTAL));
+	state.counters ["out_of_order"] = static_cast < double > (out_of_order);
+}
+
+void lf_stack_drain_reverse (benchmark::State & state) {
+	auto const PRODUCERS = static_cast < std::size_t > (state.range (0));
+	auto const MESSAGES = static_cast < std::size_t > (state.range (1));
+	auto const TOTAL = PRODUCERS * MESSAGES;
+
+	std::vector < stack_message > batch;
+	batch.reserve (TOTAL);
+
+	std::size_t out_of_order = 0;
+
+	for (auto _ : state) {
+		lf::stack < stack_message > stack;
+		fifo_checker checker { PRODUCERS };
+		std::atomic_bool go { false };
+
+		auto producers = launch_producers (PRODUCERS, go, [&](std::size_t p) {
+			for (std::size_t i = 0; i < MESSAGES; ++i) {
+				stack.push (stack_message { p, i });
+			}
+		});
+
+		go.store (true, std::memory_order_release);
+
+		// consume, drain everything and walk it backwards into fifo order
+		std::size_t received = 0;
+
+		while (received < TOTAL) {
+			batch.clear ();
+
+			if (stack.drain ([&](stack_message && msg) { batch.push_back (msg); }) == 0) {
+				_mm_pause ();
+				continue;
+			}
+
+			for (auto it = batch.rbegin (); it != batch.rend (); ++it) {
+				checker.consume (it->producer, it->sequence);
+			}
+
+			received += batch.size ();
+		}
+
+		for (auto & producer : producers) {
+			producer.join ();
+		}
+
+		out_of_order += checker.out_of_order ();
+	}
+
+	state.SetItemsProcessed (static_cast < int64_t > (state.iterations () * TOTAL));
+	state.counters ["out_of_order"] = static_cast < double > (out_of_order);
+}
+
+#define MPSC_BENCHMARK(func) BENCHMARK(func)->ArgsProduct ({ { 1, 2, 4, 7 }, { 1 << 12, 1 << 16 } })->ArgNames ({ "producers", "messages" })->Unit (benchmark::TimeUnit::kMillisecond)->UseRealTime ()
+
+MPSC_BENCHMARK (mpsc_queue_fifo);
+MPSC_BENCHMARK (lf_stack_drain_reverse);
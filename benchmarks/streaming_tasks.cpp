@@ -5,20 +5,25 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
 
 #include <functional>
 #include <filesystem>
 #include <fstream>
 #include <future>
 #include <latch>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 #include <new>
 #include <queue>
+#include <span>
 #include <xmmintrin.h>
 
 #include "binalloc/utils.h"
@@ -28,8 +33,75 @@
 
 #define THREAD_COUNT 7
 
+// every heap allocation of the process, read it around a call to count the allocations it makes
+std::atomic_size_t allocation_count{0};
+
+void *operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if(auto *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// over aligned types, like the alignas(64) tasks of the queues below, go through these instead
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    auto const align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    auto const length = size ? (size + align - 1) & ~(align - 1) : align;
+
+#if defined (_WIN32)
+    if(auto *p = _aligned_malloc(length, align)) {
+#else
+    if(auto *p = std::aligned_alloc(align, length)) {
+#endif
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+#if defined (_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+void operator delete[](void *p, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
 #if defined (__linux)
 #include <pthread.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 int is_p_core(int cpu_id) {
     char  path[256];
@@ -88,6 +160,24 @@ void set_thread_affinity(std::size_t core_id) {
     }
 }
 
+// sleep until woken as long as the word still holds the expected value
+void futex_wait(std::atomic<uint32_t> & word, uint32_t expected) {
+    syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+// wake up to count threads sleeping on the word
+void futex_wake(std::atomic<uint32_t> & word, uint32_t count) {
+    syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// cpu time used by all threads of the process
+std::chrono::nanoseconds process_cpu_time() {
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
 #elif defined (_WIN32)
 #include <Windows.h>
 
@@ -151,6 +241,35 @@ void set_thread_affinity(std::size_t core_id) {
     }
 }
 
+// atomic wait / notify sit on WaitOnAddress
+void futex_wait(std::atomic<uint32_t> & word, uint32_t expected) {
+    word.wait(expected);
+}
+
+void futex_wake(std::atomic<uint32_t> & word, uint32_t count) {
+    if(count == 1) {
+        word.notify_one();
+    } else {
+        word.notify_all();
+    }
+}
+
+// cpu time used by all threads of the process
+std::chrono::nanoseconds process_cpu_time() {
+    FILETIME creation, exit, kernel, user;
+
+    if(!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return {};
+    }
+
+    auto to_ticks = [](FILETIME const & ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32U) | ft.dwLowDateTime;
+    };
+
+    // 100ns ticks
+    return std::chrono::nanoseconds((to_ticks(kernel) + to_ticks(user)) * 100);
+}
+
 #endif
 
 using namespace glm;
@@ -228,64 +347,213 @@ namespace proto_e {
 
         std::atomic_size_t
         unresolved_children;
+
+        // range tasks of parallel_for split lazily down to grain elements, 0 for plain tasks
+        std::size_t grain;
+        std::size_t element_size;
     };
 
+    // eventcount for idle workers, every notification moves the epoch so a worker registered
+    // before a push either sees the task or wakes up from the futex right away
+    struct parking_lot {
+    public:
+        // register as sleeper, the returned key goes to park
+        uint32_t prepare_park() noexcept {
+            _sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+            // pairs with the fence in unpark, either the pusher sees the sleeper or the sleeper sees the task
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            return _epoch.load(std::memory_order_acquire);
+        }
+
+        // work showed up between prepare_park and park
+        void cancel_park() noexcept {
+            _sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void park(uint32_t key) noexcept {
+            futex_wait(_epoch, key);
+
+            _sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // wake up to count sleepers, free when nobody sleeps
+        void unpark(uint32_t count) noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if(_sleepers.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+
+            _epoch.fetch_add(1, std::memory_order_release);
+            futex_wake(_epoch, count);
+        }
+
+        void unpark_all() noexcept {
+            unpark(std::numeric_limits<int32_t>::max());
+        }
+
+    private:
+        alignas(64) std::atomic<uint32_t> _epoch{0};
+        alignas(64) std::atomic<uint32_t> _sleepers{0};
+    };
+
+    // Chase-Lev work stealing deque, the owner pushes and pops at the back without any atomic
+    // read-modify-write, thieves take from the front with a CAS. Only a pop racing thieves for
+    // the last task pays a CAS
     struct alignas(64) lane {
     public:
+        // power of two ring, grown rings keep the positions of their tasks
+        struct ring {
+            explicit ring(std::size_t capacity) :
+                mask(capacity - 1),
+                slots(new std::atomic<task *>[capacity]) {}
+
+            [[nodiscard]] std::size_t capacity() const noexcept {
+                return mask + 1;
+            }
+
+            [[nodiscard]] task *get(int64_t index) const noexcept {
+                return slots[index & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(int64_t index, task *t) noexcept {
+                slots[index & mask].store(t, std::memory_order_relaxed);
+            }
+
+            std::size_t                         mask;
+            std::unique_ptr<std::atomic<task *>[]> slots;
+        };
+
+        lane() {
+            rings.emplace_back(std::make_unique<ring>(initial_capacity));
+            task_ring.store(rings.back().get(), std::memory_order_relaxed);
+        }
+
+        // owner only
         void push(task *t) noexcept {
-            auto lock = std::scoped_lock(queue_mutex);
+            auto b = back.load(std::memory_order_relaxed);
+            auto f = front.load(std::memory_order_acquire);
+            auto *r = task_ring.load(std::memory_order_relaxed);
 
-            tasks[back & mask] = t;
-            ++back;
+            if(b - f > static_cast<int64_t>(r->mask)) {
+                r = grow(r, f, b);
+            }
+
+            r->put(b, t);
+
+            // publish the task with the new back
+            back.store(b + 1, std::memory_order_release);
         }
 
+        // owner only, newest task first
         task *pop() noexcept {
-            auto lock = std::scoped_lock(queue_mutex);
+            auto b = back.load(std::memory_order_relaxed) - 1;
+            auto *r = task_ring.load(std::memory_order_relaxed);
+
+            back.store(b, std::memory_order_relaxed);
+
+            // thieves must see the reservation before the owner reads front
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto f = front.load(std::memory_order_relaxed);
 
-            if(back == front) {
+            if(f > b) {
+                back.store(b + 1, std::memory_order_relaxed);
                 return nullptr;
             }
 
-            auto *t = tasks[back - 1 & mask];
-            --back;
+            auto *t = r->get(b);
+
+            if(f == b) {
+                // last task, race the thieves for it
+                if(!front.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    t = nullptr;
+                }
+
+                back.store(b + 1, std::memory_order_relaxed);
+            }
 
             return t;
         }
 
+        // any thread, oldest task first
         task *steal() noexcept {
-            auto lock = std::scoped_lock(queue_mutex);
+            auto f = front.load(std::memory_order_acquire);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
 
-            if(back == front) {
+            auto b = back.load(std::memory_order_acquire);
+
+            if(f >= b) {
                 return nullptr;
             }
 
-            auto *t = tasks[front & mask];
-            ++front;
+            auto *t = task_ring.load(std::memory_order_acquire)->get(f);
+
+            // lost to the owner or to another thief
+            if(!front.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
 
             return t;
         }
 
+        [[nodiscard]] bool empty() const noexcept {
+            return front.load(std::memory_order_acquire) >= back.load(std::memory_order_acquire);
+        }
+
         inline task *alloc() noexcept {
             ++task_buffer_index;
-            return task_buffer.get() + task_buffer_index;
+
+            auto *t  = task_buffer.get() + task_buffer_index;
+            t->grain = 0;
+
+            return t;
+        }
+
+        [[nodiscard]] inline bool can_alloc() const noexcept {
+            return task_buffer_index + 1 < task_buffer_capacity;
         }
 
         inline void alloc_free() noexcept {
             task_buffer_index = 0;
         }
 
-        uint64_t   front, back;
-        spin_mutex queue_mutex;
+        // thieves and the owner live on separate cache lines
+        alignas(64) std::atomic<int64_t> front{0};
+        alignas(64) std::atomic<int64_t> back{0};
+
+        // thieves may still read from a replaced ring, those are only released with the lane
+        std::vector<std::unique_ptr<ring>> rings;
+        std::atomic<ring *>                task_ring{nullptr};
 
         // off critical path ( good ? / bad ? )
-        std::unique_ptr<task *[]> tasks{new task *[8192]};
-        std::unique_ptr<task[]>   task_buffer{new task[8192]};
+        std::unique_ptr<task[]>   task_buffer{new task[task_buffer_capacity]};
 
         std::size_t task_buffer_index{0};
 
-        bool running{false};
+        std::atomic_bool running{false};
 
-        static constexpr std::size_t mask{8192 - 1};
+        static constexpr std::size_t initial_capacity{1024};
+        static constexpr std::size_t task_buffer_capacity{8192};
+
+    private:
+        ring *grow(ring *r, int64_t f, int64_t b) {
+            auto grown = std::make_unique<ring>(r->capacity() * 2);
+
+            for(auto i = f; i < b; ++i) {
+                grown->put(i, r->get(i));
+            }
+
+            auto *next = grown.get();
+            rings.push_back(std::move(grown));
+
+            task_ring.store(next, std::memory_order_release);
+
+            return next;
+        }
     };
 
     struct executor {
@@ -304,13 +572,16 @@ namespace proto_e {
                 lane.running = false;
             }
 
+            idle_workers.unpark_all();
+
             for(auto & worker: workers) {
                 if(worker.joinable())
                     worker.join();
             }
         }
 
-        inline static void run_lane(std::vector<lane> & lanes, lane & l, unsigned i) {
+        // run one task of the lane or stolen from another one, false when there was none
+        inline bool run_lane(std::vector<lane> & lanes, lane & l, unsigned i) {
             auto *t = l.pop();
 
             // if no job available, try steal
@@ -321,11 +592,85 @@ namespace proto_e {
                     t = lanes[rand_index].steal();
             }
 
-            if(t) {
-                t->call();
+            if(!t) {
+                return false;
+            }
+
+            if(t->grain != 0) {
+                run_range(l, *t);
             } else {
-                std::this_thread::yield();
+                t->call();
+            }
+
+            return true;
+        }
+
+        // lazy binary splitting, the range is processed grain by grain and only split in half while
+        // the lane has nothing left for thieves. Busy workers never split, idle ones always find
+        // half of a range to steal, every split wakes up one of them
+        inline void run_range(lane & l, task & t) {
+            auto *begin = static_cast<char *>(t.data_begin);
+            auto *end   = static_cast<char *>(t.data_end);
+
+            while(begin != end) {
+                auto const remaining = static_cast<std::size_t>(end - begin) / t.element_size;
+
+                if(remaining > t.grain && l.empty() && l.can_alloc()) {
+                    auto *half = begin + remaining / 2 * t.element_size;
+
+                    task *split = l.alloc();
+
+                    split->callback     = t.callback;
+                    split->data_begin   = half;
+                    split->data_end     = end;
+                    split->parent       = t.parent;
+                    split->grain        = t.grain;
+                    split->element_size = t.element_size;
+
+                    ++(t.parent->unresolved_children);
+                    l.push(split);
+                    idle_workers.unpark(1);
+
+                    end = half;
+                    continue;
+                }
+
+                auto *chunk_end = remaining > t.grain ? begin + t.grain * t.element_size : end;
+
+                t.callback(begin, chunk_end);
+                begin = chunk_end;
+            }
+
+            --(t.parent->unresolved_children);
+        }
+
+        // park until the next push, called once a worker spun idle for a while
+        void idle(lane & l) {
+            auto key = idle_workers.prepare_park();
+
+            // a push before the registration is visible now, later ones wake us up
+            if(!l.running || has_work()) {
+                idle_workers.cancel_park();
+                return;
             }
+
+            idle_workers.park(key);
+        }
+
+        [[nodiscard]] bool has_work() const noexcept {
+            for(auto & l: lanes) {
+                if(!l.empty()) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // push a single task onto the lane of the calling thread
+        void push(task *t) {
+            get_this_lane().push(t);
+            idle_workers.unpark(1);
         }
 
         void run() {
@@ -334,8 +679,10 @@ namespace proto_e {
 
             lanes[0].running = true;
 
-            // init workers
+            // init workers, lanes are marked running up front so a stop can't be overtaken
             for(unsigned i = 1; i < physical_cores.size(); ++i) {
+                lanes[i].running = true;
+
                 workers[i] = std::thread(
                     [this, i, core=physical_cores[i]]() {
                         // set cpu affinity
@@ -344,10 +691,18 @@ namespace proto_e {
                         auto & lane = lanes[i];
 
                         // run
-                        lane.running = true;
-
-                        while(lane.running)
-                            run_lane(lanes, lane, i);
+                        unsigned idle_spins = 0;
+
+                        while(lane.running) {
+                            if(run_lane(lanes, lane, i)) {
+                                idle_spins = 0;
+                            } else if(++idle_spins < idle_spin_limit) {
+                                _mm_pause();
+                            } else {
+                                idle_spins = 0;
+                                idle(lane);
+                            }
+                        }
                     });
             }
         }
@@ -355,8 +710,11 @@ namespace proto_e {
         void wait_for(task *t) {
             auto & lane = get_this_lane();
 
-            while(t->unresolved_children.load(std::memory_order_relaxed) != 0) {
-                run_lane(lanes, lane, 0);
+            // acquire, the tasks of other lanes are done with their buffers once this reads 0
+            while(t->unresolved_children.load(std::memory_order_acquire) != 0) {
+                if(!run_lane(lanes, lane, 0)) {
+                    std::this_thread::yield();
+                }
             }
         }
 
@@ -390,6 +748,8 @@ namespace proto_e {
                 lane.push(t);
             }
 
+            idle_workers.unpark(job_div);
+
             wait_for(parent);
 
             for(auto & f_lane: lanes)
@@ -428,6 +788,38 @@ namespace proto_e {
                 lane.push(t);
             }
 
+            idle_workers.unpark(job_div);
+
+            wait_for(parent);
+
+            for(auto & f_lane: lanes)
+                f_lane.alloc_free();
+        }
+
+        // parallel for with lazy binary splitting, ranges only split when idle workers need work
+        /// \param grain elements below which a range is never split
+        template <typename _data_t>
+        inline void parallel_for(
+            _data_t *   data,
+            std::size_t length,
+            void (*     callback)(_data_t *begin, _data_t *end),
+            std::size_t grain = default_grain) {
+            auto & lane = get_this_lane();
+
+            task *parent                = lane.alloc();
+            parent->unresolved_children = 1;
+
+            task *root = lane.alloc();
+
+            root->callback     = (task_callback)callback;
+            root->data_begin   = data;
+            root->data_end     = data + length;
+            root->parent       = parent;
+            root->grain        = std::max<std::size_t>(grain, 1);
+            root->element_size = sizeof(_data_t);
+
+            run_range(lane, *root);
+
             wait_for(parent);
 
             for(auto & f_lane: lanes)
@@ -448,6 +840,10 @@ namespace proto_e {
         std::vector<std::size_t> physical_cores;
         std::vector<lane>        lanes;
         std::vector<std::thread> workers;
+        parking_lot              idle_workers;
+
+        static constexpr unsigned idle_spin_limit{1024};
+        static constexpr std::size_t default_grain{64};
     };
 }
 
@@ -718,40 +1114,220 @@ namespace proto_g {
         std::atomic_bool _lock{false};
     };
 
-    struct sync_token {
+    // move only callable stored inline, it never allocates. Callables that don't fit the buffer
+    // are rejected at compile time
+    template <std::size_t buffer_size>
+    struct inline_function {
     public:
-        [[nodiscard]] bool done() const { return _unresolved->load() == 0; }
+        inline_function() = default;
 
-        static sync_token make(std::uint64_t const initial_unresolved) {
-            sync_token tk;
-            *tk._unresolved = initial_unresolved;
+        template <typename fn_t>
+            requires (!std::is_same_v<std::decay_t<fn_t>, inline_function>)
+        inline_function(fn_t && fn) {
+            using callable_t = std::decay_t<fn_t>;
 
-            return tk;
+            static_assert(sizeof(callable_t) <= buffer_size, "callable does not fit the inline buffer");
+            static_assert(alignof(callable_t) <= alignof(void *), "callable is over aligned for the inline buffer");
+
+            new(_buffer) callable_t(std::forward<fn_t>(fn));
+            _manage = &manage<callable_t>;
+        }
+
+        inline_function(inline_function && other) noexcept {
+            other.move_to(*this);
+        }
+
+        inline_function & operator = (inline_function && other) noexcept {
+            if(this != &other) {
+                reset();
+                other.move_to(*this);
+            }
+
+            return *this;
+        }
+
+        ~inline_function() {
+            reset();
+        }
+
+        void operator()() {
+            _manage(operation::invoke, _buffer, nullptr);
+        }
+
+        explicit operator bool () const {
+            return _manage != nullptr;
+        }
+
+        void reset() {
+            if(_manage) {
+                _manage(operation::destroy, _buffer, nullptr);
+                _manage = nullptr;
+            }
         }
 
     private:
-        friend struct task;
+        enum class operation { invoke, move, destroy };
+
+        // a single entry point per callable type keeps the function down to one pointer besides the buffer
+        using manage_t = void (*)(operation, void *self, void *target);
+
+        template <typename callable_t>
+        static void manage(operation op, void *self, void *target) {
+            auto *callable = static_cast<callable_t *>(self);
+
+            switch(op) {
+                case operation::invoke:
+                    (*callable)();
+                    break;
+                case operation::move:
+                    new(target) callable_t(std::move(*callable));
+                    callable->~callable_t();
+                    break;
+                case operation::destroy:
+                    callable->~callable_t();
+                    break;
+            }
+        }
 
-        void resolve() const {
-            _unresolved->fetch_sub(1, std::memory_order_acq_rel);
+        void move_to(inline_function & target) noexcept {
+            if(_manage) {
+                _manage(operation::move, _buffer, target._buffer);
+
+                target._manage = _manage;
+                _manage = nullptr;
+            }
+        }
+
+        manage_t _manage{nullptr};
+        alignas(void *) std::byte _buffer[buffer_size];
+    };
+
+    struct completion_counter_pool;
+
+    // completion counter of a submission, held by its tasks and its tokens. The last holder hands it
+    // back to the pool of the executor
+    struct completion_counter {
+        void release() {
+            if(holders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                recycle();
+            }
+        }
+
+        void recycle();
+
+        std::atomic_uint64_t      unresolved{0};
+        std::atomic_uint32_t      holders{0};
+        completion_counter_pool * pool{nullptr};
+        completion_counter *      next{nullptr};
+    };
+
+    // counters are carved out of slabs that stay with the pool, a steady stream of submissions
+    // recycles the same counters
+    struct completion_counter_pool {
+    public:
+        static constexpr std::size_t slab_size = 64;
+
+        completion_counter * acquire(uint64_t unresolved, uint32_t holders) {
+            auto lock = std::scoped_lock(_mutex);
+
+            if(!_free) {
+                grow();
+            }
+
+            auto *counter = _free;
+            _free = counter->next;
+
+            counter->unresolved.store(unresolved, std::memory_order_relaxed);
+            counter->holders.store(holders, std::memory_order_relaxed);
+
+            return counter;
+        }
+
+        void recycle(completion_counter * counter) {
+            auto lock = std::scoped_lock(_mutex);
+
+            counter->next = _free;
+            _free = counter;
         }
 
-        std::shared_ptr<std::atomic_uint64_t> _unresolved = std::make_shared<std::atomic_uint64_t>(0);
+    private:
+        void grow() {
+            auto & slab = _slabs.emplace_back(new completion_counter[slab_size]);
+
+            for(std::size_t i = 0; i < slab_size; ++i) {
+                slab[i].pool = this;
+                slab[i].next = _free;
+                _free = &slab[i];
+            }
+        }
+
+        std::vector<std::unique_ptr<completion_counter[]>> _slabs;
+        completion_counter *                                _free{nullptr};
+        spin_mutex                                          _mutex;
     };
 
-    struct task {
+    inline void completion_counter::recycle() {
+        pool->recycle(this);
+    }
+
+    // handle on the completion of a submission
+    // \note tokens must not outlive their executor
+    struct sync_token {
+    public:
+        sync_token() = default;
+
+        sync_token(sync_token const & other) :
+            _counter(other._counter) {
+            if(_counter) {
+                _counter->holders.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        sync_token(sync_token && other) noexcept :
+            _counter(std::exchange(other._counter, nullptr)) {}
+
+        sync_token & operator = (sync_token other) noexcept {
+            std::swap(_counter, other._counter);
+            return *this;
+        }
+
+        ~sync_token() {
+            if(_counter) {
+                _counter->release();
+            }
+        }
+
+        [[nodiscard]] bool done() const {
+            return !_counter || _counter->unresolved.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend struct executor;
+
+        // takes over a holder reference
+        explicit sync_token(completion_counter * counter) :
+            _counter(counter) {}
+
+        completion_counter * _counter{nullptr};
+    };
+
+    // 48 bytes of captures, the task fills exactly one cache line
+    using task_function = inline_function<48>;
+
+    struct alignas(64) task {
         struct resolve_guard {
             ~resolve_guard() {
-                unresolved.fetch_sub(1, std::memory_order_acq_rel);
+                counter.unresolved.fetch_sub(1, std::memory_order_acq_rel);
+                counter.release();
             }
 
-            std::atomic_uint64_t & unresolved;
+            completion_counter & counter;
         };
 
-        void invoke() const {
+        void invoke() {
             try {
                 if (callback) {
-                    auto guard = resolve_guard{.unresolved = *tk._unresolved};
+                    auto guard = resolve_guard{.counter = *counter};
                     callback();
                 }
             } catch(...) {}
@@ -761,8 +1337,50 @@ namespace proto_g {
             return static_cast<bool>(callback);
         }
 
-        std::function<void ()> callback;
-        sync_token             tk;
+        task_function        callback;
+        completion_counter * counter{nullptr};
+    };
+
+    static_assert(sizeof(task) == 64, "a task is expected to fill a single cache line");
+
+    // fifo ring of tasks that only grows, once sized it allocates nothing
+    struct task_queue {
+    public:
+        [[nodiscard]] bool empty() const {
+            return _front == _back;
+        }
+
+        void push_back(task && t) {
+            if(_back - _front == _capacity) {
+                grow();
+            }
+
+            _slots[_back++ & (_capacity - 1)] = std::move(t);
+        }
+
+        task pop_front() {
+            return std::move(_slots[_front++ & (_capacity - 1)]);
+        }
+
+    private:
+        void grow() {
+            auto capacity = _capacity ? _capacity * 2 : initial_capacity;
+            auto slots    = std::make_unique<task[]>(capacity);
+
+            for(auto i = _front; i < _back; ++i) {
+                slots[i & (capacity - 1)] = std::move(_slots[i & (_capacity - 1)]);
+            }
+
+            _slots    = std::move(slots);
+            _capacity = capacity;
+        }
+
+        static constexpr std::size_t initial_capacity = 256;
+
+        std::unique_ptr<task[]> _slots;
+        std::size_t             _capacity{0};
+        std::size_t             _front{0};
+        std::size_t             _back{0};
     };
 
     struct executor {
@@ -789,8 +1407,7 @@ namespace proto_g {
                                     return;
                                 }
 
-                                current_task = std::move(_task_queue.front());
-                                _task_queue.pop_front();
+                                current_task = _task_queue.pop_front();
                             }
 
                             current_task.invoke();
@@ -814,30 +1431,33 @@ namespace proto_g {
             }
         }
 
-        sync_token push (std::function<void ()> && callback) {
-            auto tk = sync_token::make(1);
+        template < typename callback_t >
+        sync_token push (callback_t && callback) {
+            // one holder for the task, one for the token
+            auto *counter = _counters.acquire(1, 2);
 
             {
                 auto lock = std::scoped_lock(_mutex);
 
                 _task_queue.push_back(
                     task{
-                        .callback = std::forward<std::function<void ()>>(callback),
-                        .tk       = tk});
+                        .callback = task_function(std::forward<callback_t>(callback)),
+                        .counter  = counter});
             }
 
             _cv.notify_one();
 
-            return tk;
+            return sync_token(counter);
         }
 
-        template < typename data_type >
-        sync_token push_parallel (std::span < data_type > data, std::function < void (std::span < data_type >) > const & task_fn) {
+        // every chunk task carries its own copy of task_fn, small callables keep the submission free of allocations
+        template < typename data_type, typename task_fn_t >
+        sync_token push_parallel (std::span < data_type > data, task_fn_t const & task_fn) {
             // divide work in chunks of multiples of pages
             auto job_div = _workers.size() * 16; // find a decent division factor
 
-            // token for synchronization
-            auto tk = sync_token::make(job_div);
+            // counter for synchronization, held by every chunk and the token
+            auto *counter = _counters.acquire(job_div, job_div + 1);
 
             auto stride = data.size() / job_div;
             auto rem    = data.size() % job_div;
@@ -858,14 +1478,14 @@ namespace proto_g {
                         .callback = [data_span = std::span < data_type > (data.data() + offset, stride), task_fn]() {
                             task_fn(data_span);
                         },
-                        .tk = tk});
+                        .counter = counter});
             }
 
             // notify workers
             _cv.notify_all();
 
             // ----------
-            return tk;
+            return sync_token(counter);
         }
 
         void busy_wait_for (sync_token const & tk) {
@@ -880,7 +1500,7 @@ namespace proto_g {
                     auto lock = std::scoped_lock(_mutex);
 
                     if (!_task_queue.empty()) {
-                        current_task = std::move(_task_queue.front());
+                        current_task = _task_queue.pop_front();
                     }
                 }
 
@@ -895,8 +1515,9 @@ namespace proto_g {
 
     private:
 
+        completion_counter_pool     _counters;
         std::vector <std::thread>   _workers;
-        std::deque<task>            _task_queue;
+        task_queue                  _task_queue;
         spin_mutex                  _mutex;
         std::condition_variable_any _cv;
         std::atomic_bool            _is_running{true};
@@ -913,6 +1534,193 @@ void SEQ_BASELINE(benchmark::State & state) {
     }
 }
 
+inline void PROTO_E(benchmark::State & state) {
+    proto_e::executor exec_e{};
+    exec_e.run();
+
+    for(auto _: state) {
+        auto range = state.range(0);
+
+        exec_e.run_parallel_many<transformer>(
+            test_data.data(),
+            range,
+            [](transformer *begin, transformer *end) {
+                for(auto *trm = begin; trm != end; ++trm) {
+                    trm->update_matrix();
+                }
+            });
+    }
+}
+
+// per element cost of the skewed workload, the last eighth of the range costs 32 times as much
+std::size_t skewed_length = 0;
+
+void update_skewed(transformer *begin, transformer *end) {
+    for(auto *trm = begin; trm != end; ++trm) {
+        auto const index  = static_cast<std::size_t>(trm - test_data.data());
+        auto const repeat = index * 8 >= skewed_length * 7 ? 32 : 1;
+
+        for(int r = 0; r < repeat; ++r) {
+            trm->update_matrix();
+        }
+    }
+}
+
+void update_uniform(transformer *begin, transformer *end) {
+    for(auto *trm = begin; trm != end; ++trm) {
+        trm->update_matrix();
+    }
+}
+
+// range(1) is the grain
+inline void PROTO_E_LBS(benchmark::State & state) {
+    proto_e::executor exec_e{};
+    exec_e.run();
+
+    for(auto _: state) {
+        exec_e.parallel_for<transformer>(test_data.data(), state.range(0), update_uniform, state.range(1));
+    }
+}
+
+inline void PROTO_E_SKEWED(benchmark::State & state) {
+    proto_e::executor exec_e{};
+    exec_e.run();
+
+    skewed_length = state.range(0);
+
+    for(auto _: state) {
+        exec_e.run_parallel_many<transformer>(test_data.data(), state.range(0), update_skewed);
+    }
+}
+
+inline void PROTO_E_LBS_SKEWED(benchmark::State & state) {
+    proto_e::executor exec_e{};
+    exec_e.run();
+
+    skewed_length = state.range(0);
+
+    for(auto _: state) {
+        exec_e.parallel_for<transformer>(test_data.data(), state.range(0), update_skewed, state.range(1));
+    }
+}
+
+inline void PROTO_G_SKEWED(benchmark::State & state) {
+    proto_g::executor exec{};
+
+    skewed_length = state.range(0);
+
+    for(auto _: state) {
+        std::span<transformer>::size_type range = state.range(0);
+
+        auto tk = exec.push_parallel<transformer>(
+            {test_data.data(), range},
+            [](std::span<transformer> data) {
+                update_skewed(data.data(), data.data() + data.size());
+            });
+
+        exec.busy_wait_for(tk);
+    }
+}
+
+// cores kept busy by an executor without any work
+inline void PROTO_E_IDLE(benchmark::State & state) {
+    proto_e::executor exec_e{};
+    exec_e.run();
+
+    auto const idle_period = std::chrono::milliseconds(state.range(0));
+
+    std::chrono::nanoseconds idle_cpu{0};
+    std::chrono::nanoseconds idle_wall{0};
+
+    for(auto _: state) {
+        auto cpu_begin  = process_cpu_time();
+        auto wall_begin = std::chrono::steady_clock::now();
+
+        std::this_thread::sleep_for(idle_period);
+
+        idle_cpu += process_cpu_time() - cpu_begin;
+        idle_wall += std::chrono::steady_clock::now() - wall_begin;
+    }
+
+    state.counters["workers"] = static_cast<double>(exec_e.workers.size() - 1);
+    state.counters["idle_cores"] = static_cast<double>(idle_cpu.count()) / static_cast<double>(idle_wall.count());
+}
+
+// time from a push until an idle worker starts the task, range(0) is the idle time before the push
+inline void PROTO_E_WAKEUP(benchmark::State & state) {
+    proto_e::executor exec_e{};
+    exec_e.run();
+
+    if(exec_e.workers.size() < 2) {
+        state.SkipWithError("no worker threads");
+        return;
+    }
+
+    std::atomic_int64_t started{0};
+
+    proto_e::task parent{};
+    proto_e::task t{};
+
+    t.callback = [](void *data_begin, void *) {
+        static_cast<std::atomic_int64_t *>(data_begin)->store(
+            std::chrono::steady_clock::now().time_since_epoch().count(),
+            std::memory_order_relaxed);
+    };
+
+    t.data_begin = &started;
+    t.parent     = &parent;
+
+    for(auto _: state) {
+        std::this_thread::sleep_for(std::chrono::microseconds(state.range(0)));
+
+        parent.unresolved_children = 1;
+
+        // the calling thread only waits, a worker has to steal the task
+        auto begin = std::chrono::steady_clock::now();
+        exec_e.push(&t);
+
+        while(parent.unresolved_children.load(std::memory_order_acquire) != 0) {
+            _mm_pause();
+        }
+
+        auto const latency = std::chrono::steady_clock::duration(started.load(std::memory_order_relaxed)) - begin.time_since_epoch();
+        state.SetIterationTime(std::chrono::duration<double>(latency).count());
+    }
+}
+
+// heap allocations made by submitting a parallel for, a first submission sizes the queue and the counter pool
+inline void PROTO_G_ALLOCS(benchmark::State & state) {
+    proto_g::executor exec{};
+
+    std::span<transformer>::size_type range = state.range(0);
+
+    auto update = [](std::span<transformer> data) {
+        for(auto & trm: data) {
+            trm.update_matrix();
+        }
+    };
+
+    auto const first = allocation_count.load(std::memory_order_relaxed);
+
+    exec.busy_wait_for(exec.push_parallel<transformer>({test_data.data(), range}, update));
+
+    auto const first_allocations = allocation_count.load(std::memory_order_relaxed) - first;
+
+    std::size_t allocations = 0;
+
+    for(auto _: state) {
+        auto before = allocation_count.load(std::memory_order_relaxed);
+        auto tk     = exec.push_parallel<transformer>({test_data.data(), range}, update);
+
+        allocations += allocation_count.load(std::memory_order_relaxed) - before;
+
+        exec.busy_wait_for(tk);
+    }
+
+    state.counters["allocs_first_push_parallel"] = static_cast<double>(first_allocations);
+    state.counters["allocs_per_push_parallel"]   = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+}
+
 inline void PROTO_F(benchmark::State & state) {
     proto_f::executor exec_f{};
 
@@ -949,10 +1757,21 @@ inline void PROTO_G(benchmark::State & state) {
     }
 }
 
-#define MY_BENCHMARK(x) BENCHMARK(x)->Range(MIN_ITERATION_RANGE, MAX_ITERATION_RANGE)->Unit(benchmark::TimeUnit::kMillisecond)
+#define MY_BENCHMARK(x) BENCHMARK(x)->Range(MIN_ITERATION_RANGE, MAX_ITERATION_RANGE)->Unit(benchmark::TimeUnit::kMillisecond)->UseRealTime()
 
 MY_BENCHMARK(SEQ_BASELINE);
+MY_BENCHMARK(PROTO_E);
+BENCHMARK(PROTO_E_IDLE)->Arg(100)->Unit(benchmark::TimeUnit::kMillisecond)->UseRealTime();
+BENCHMARK(PROTO_E_WAKEUP)->Arg(0)->Arg(100)->Arg(10000)->Unit(benchmark::TimeUnit::kMicrosecond)->UseManualTime();
 //MY_BENCHMARK(PROTO_F);
 MY_BENCHMARK(PROTO_G);
+BENCHMARK(PROTO_G_ALLOCS)->Arg(MIN_ITERATION_RANGE)->Unit(benchmark::TimeUnit::kMillisecond)->UseRealTime();
+
+#define LBS_BENCHMARK(x) BENCHMARK(x)->ArgsProduct({benchmark::CreateRange(MIN_ITERATION_RANGE, MAX_ITERATION_RANGE, 8), {16, 256}})->ArgNames({"range", "grain"})->Unit(benchmark::TimeUnit::kMillisecond)->UseRealTime()
+
+LBS_BENCHMARK(PROTO_E_LBS);
+MY_BENCHMARK(PROTO_E_SKEWED);
+LBS_BENCHMARK(PROTO_E_LBS_SKEWED);
+MY_BENCHMARK(PROTO_G_SKEWED);
 
 BENCHMARK_MAIN();
@@ -66,6 +66,56 @@ void run_pop_mutex (list_t & list, mutex_t & mtx) {
 	run_pop(list);
 }
 
+#define MAX_BATCH_SIZE 64U
+
+template < typename list_t >
+void run_push_batch (list_t & list, std::size_t batch_size) {
+	int values [MAX_BATCH_SIZE];
+
+	for (std::size_t i = 0; i < batch_size; ++i) {
+		values [i] = las::test::uniform(1000);
+	}
+
+	list.push_range (values, values + batch_size);
+}
+
+template < typename list_t >
+void run_pop_batch (list_t & list, std::size_t batch_size) {
+	int values [MAX_BATCH_SIZE];
+	benchmark::DoNotOptimize (list.pop_n (batch_size, values));
+}
+
+template < typename list_t >
+void run_drain (list_t & list) {
+	int sum = 0;
+	list.drain ([&](int value) { sum += value; });
+	benchmark::DoNotOptimize (sum);
+}
+
+template < typename list_t, typename mutex_t >
+void run_push_batch_mutex (list_t & list, mutex_t & mtx, std::size_t batch_size) {
+	int values [MAX_BATCH_SIZE];
+
+	for (std::size_t i = 0; i < batch_size; ++i) {
+		values [i] = las::test::uniform(1000);
+	}
+
+	std::unique_lock const LOCK { mtx };
+
+	for (std::size_t i = 0; i < batch_size; ++i) {
+		list.push (values [i]);
+	}
+}
+
+template < typename list_t, typename mutex_t >
+void run_pop_batch_mutex (list_t & list, mutex_t & mtx, std::size_t batch_size) {
+	std::unique_lock const LOCK { mtx };
+
+	for (std::size_t i = 0; i < batch_size && !list.empty(); ++i) {
+		list.pop();
+	}
+}
+
 //ptbench::executor exec { ptbench::exec_policy::per_physical_core_affinity };
 las::test::concurrent_stress_tester stresser {};
 
@@ -106,6 +156,66 @@ void run_benchmark (benchmark::State & state) {
 	}
 }
 
+template < typename list_t >
+void run_benchmark_batch (benchmark::State & state) {
+	list_t list;
+	auto const BATCH_SIZE = static_cast < std::size_t > (state.range(1));
+
+	for (auto _ : state) {
+		// clear list
+		list.drain ([](int) {});
+
+		stresser.dispatch ({
+				{ [&]{ run_push_batch (list, BATCH_SIZE); }, 50 },
+				{ [&]{ run_pop_batch (list, BATCH_SIZE); }, 50 }
+			},
+			state.range(0));
+	}
+
+	state.SetItemsProcessed (state.iterations() * state.range(0) * state.range(1));
+}
+
+template < typename list_t >
+void run_benchmark_batch_drain (benchmark::State & state) {
+	list_t list;
+	auto const BATCH_SIZE = static_cast < std::size_t > (state.range(1));
+
+	for (auto _ : state) {
+		// clear list
+		list.drain ([](int) {});
+
+		stresser.dispatch ({
+				{ [&]{ run_push_batch (list, BATCH_SIZE); }, 90 },
+				{ [&]{ run_drain (list); }, 10 }
+			},
+			state.range(0));
+	}
+
+	state.SetItemsProcessed (state.iterations() * state.range(0) * state.range(1));
+}
+
+template < typename list_t, typename mutex_t >
+void run_benchmark_batch_mutex (benchmark::State & state) {
+	list_t list;
+	mutex_t mtx;
+	auto const BATCH_SIZE = static_cast < std::size_t > (state.range(1));
+
+	for (auto _ : state) {
+		// clear list
+		while(!list.empty ()) {
+			list.pop();
+		}
+
+		stresser.dispatch ({
+				{ [&]{ run_push_batch_mutex (list, mtx, BATCH_SIZE); }, 50 },
+				{ [&]{ run_pop_batch_mutex (list, mtx, BATCH_SIZE); }, 50 }
+			},
+			state.range(0));
+	}
+
+	state.SetItemsProcessed (state.iterations() * state.range(0) * state.range(1));
+}
+
 #define MIN_ITERATION_RANGE 1 << 14U
 #define MAX_ITERATION_RANGE 1 << 16U
 
@@ -114,4 +224,10 @@ void run_benchmark (benchmark::State & state) {
 //MY_BENCHMARK ((run_benchmark_mutex <std::list <int>, std::mutex >), "mutex - std::list");
 MY_BENCHMARK (run_benchmark < lf::stack < int > >, "lockfree stack");
 MY_BENCHMARK ((run_benchmark_mutex <std::stack<int>, spin_mutex >), "spin - std::stack");
-//MY_BENCHMARK (run_benchmark < demo_b::stack < int > >, "embeded spin stack");
\ No newline at end of file
+//MY_BENCHMARK (run_benchmark < demo_b::stack < int > >, "embeded spin stack");
+
+#define MY_BATCH_BENCHMARK(func, name) BENCHMARK((func))->ArgsProduct ({ benchmark::CreateRange (MIN_ITERATION_RANGE, MAX_ITERATION_RANGE, 4), { 1, 4, 16, MAX_BATCH_SIZE } })->ArgNames ({ "ops", "batch" })->Name(name)->Unit(benchmark::TimeUnit::kMillisecond)->UseRealTime()
+
+MY_BATCH_BENCHMARK (run_benchmark_batch < lf::stack < int > >, "lockfree stack - push_range / pop_n");
+MY_BATCH_BENCHMARK (run_benchmark_batch_drain < lf::stack < int > >, "lockfree stack - push_range / drain");
+MY_BATCH_BENCHMARK ((run_benchmark_batch_mutex <std::stack<int>, spin_mutex >), "spin - std::stack batch");
@@ -1,36 +1,132 @@
+#include <algorithm>
 #include <atomic>
 #include <benchmark/benchmark.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <stdexcept>
 #include <thread>
-
-#include <las/las.h>
+#include <vector>
+#include <xmmintrin.h>
 
 namespace gc {
 
-	enum struct tracking_state : uint8_t {
-		active,
-		marked,
-		unreachable
-	};
-
 	using dctor_callback = void(*)(void *);
 
+	// a registered reference knows its slot in the table of its owner, next links free references
+	// references living on the root stack of a thread have no owner
 	struct reference {
-		reference*						next { nullptr };
 		std::atomic < struct object* >	to { nullptr };
-		std::atomic < tracking_state >	state { tracking_state::active };
+		struct object *					owner { nullptr };
+		uint32_t						slot { 0 };
+		reference*						next { nullptr };
+	};
+
+	// references registered on an object. Unregistering clears the slot of the reference, the
+	// holes are squeezed out in bulk when the table is traced or has to grow
+	struct reference_table {
+		static constexpr uint32_t inline_capacity = 2;
+
+		reference_table() = default;
+
+		reference_table(reference_table const &) = delete;
+		reference_table & operator = (reference_table const &) = delete;
+
+		~reference_table() {
+			if (slots != inline_slots) {
+				delete [] slots;
+			}
+		}
+
+		// tables of shared objects are locked by every access, tables of objects under construction
+		// are only accessed by the constructing thread
+		void lock() {
+			while (busy.test_and_set (std::memory_order_acquire)) {
+				_mm_pause();
+			}
+		}
+
+		void unlock() {
+			busy.clear (std::memory_order_release);
+		}
+
+		void push(reference * ref) {
+			if (size == capacity) {
+				compact ([](reference *) {});
+
+				// grow unless squeezing freed a good share of the table
+				if (size > capacity / 2) {
+					grow();
+				}
+			}
+
+			ref->slot = size;
+			slots [size++] = ref;
+		}
+
+		void erase(reference * ref) {
+			slots [ref->slot] = nullptr;
+		}
+
+		// drop the holes and visit the remaining references
+		template < typename visit_f >
+		void compact(visit_f && visit) {
+			uint32_t kept = 0;
+
+			for (uint32_t i = 0; i < size; ++i) {
+				if (auto * ref = slots [i]) {
+					ref->slot = kept;
+					slots [kept++] = ref;
+
+					visit (ref);
+				}
+			}
+
+			size = kept;
+		}
+
+		reference **		slots { inline_slots };
+		uint32_t			size { 0 };
+		uint32_t			capacity { inline_capacity };
+		std::atomic_flag	busy;
+		reference *			inline_slots [inline_capacity] { nullptr, nullptr };
+
+	private:
+
+		void grow() {
+			auto * grown = new reference * [capacity * 2];
+
+			std::copy (slots, slots + size, grown);
+
+			if (slots != inline_slots) {
+				delete [] slots;
+			}
+
+			slots = grown;
+			capacity *= 2;
+		}
 	};
 
+	// header of a managed object, the payload follows it in the same allocation
+	// an object is marked when its color matches the mark color of the running cycle, every cycle
+	// flips the mark color so no pass is needed to clear the previous marks
 	struct object {
 		object*							next { nullptr };
 		object*							next_marked { nullptr };
 		void *							payload { nullptr };
 		dctor_callback					dctor { nullptr };
-		std::atomic < tracking_state >	state { tracking_state::active };
-		std::atomic < reference* >		ref_head { nullptr };
+		std::atomic < uint8_t >			color { 0 };
+		reference_table					refs;
 	};
 
+	// offset of a payload of type t from the start of its object header
+	template < typename t >
+	constexpr std::size_t payload_offset = (sizeof (object) + alignof (t) - 1) / alignof (t) * alignof (t);
+
 	template < typename t >
 	void list_push_front (std::atomic < t* > & head, t * node, t * t::*next_field_addr = &t::next) {
 		// lockfree push front
@@ -89,564 +185,1000 @@ namespace gc {
 		while (head.compare_exchange_weak(
 			detached_head,
 			nullptr,
-			std::memory_order_release,
+			std::memory_order_acq_rel,
 			std::memory_order_relaxed) == false)
 		{ /* spin */ }
 
 		return detached_head;
 	}
 
-	template < typename t, typename release_f >
-	void list_collect (std::atomic < t * > & head, release_f && release, bool check_state = true) {
+	// color of garbage waiting for its destructor, the references it owns protect nothing anymore
+	constexpr uint8_t reclaimed_color = 0xff;
 
-		// detach the list
-		auto * detached_head = list_detach (head);
+	// -- marking strategies --
+	// a strategy drains the gray objects shared with the mutator barriers in its own traversal
+	// order, the tracker hands it trace, which marks the targets of an object and passes the
+	// newly marked ones to a sink
 
-		// traverse the list
-		while (detached_head != nullptr) {
-			auto * next_ptr = detached_head->next;
+	// traces in waves, the objects marked by one wave form the next one
+	struct breadth_first_marking {
+		template < typename tracker_t >
+		void drain(tracker_t & tracker) {
+			auto * wave = tracker.take_gray();
 
-			if (check_state == false || detached_head->state == tracking_state::unreachable) {
-				// remove the object
-				release (detached_head);
-			} else if (detached_head->state == tracking_state::active){
-				// push the object back to the list
-				list_push_front (head, detached_head);
-			} else {
-				// something really bad happened
-				throw std::runtime_error ("object marked for collection is still reachable");
-			}
+			while (wave != nullptr) {
+				object * next_wave = nullptr;
+
+				while (wave != nullptr) {
+					auto * obj = list_pop_front (wave, &object::next_marked);
 
-			detached_head = next_ptr;
+					tracker.trace (obj, [&next_wave] (object * target) {
+						list_push_front (next_wave, target, &object::next_marked);
+					});
+				}
+
+				wave = next_wave;
+			}
 		}
-	}
+	};
 
-	struct tracker {
+	// traces the most recently marked object first, keeps the working set small
+	struct depth_first_marking {
+		template < typename tracker_t >
+		void drain(tracker_t & tracker) {
+			for (auto * obj = tracker.take_gray(); obj != nullptr; obj = obj->next_marked) {
+				_stack.push_back (obj);
+			}
 
-		static tracker & instance ();
+			while (!_stack.empty()) {
+				auto * obj = _stack.back();
+				_stack.pop_back();
 
-		void register_collector_thread(std::thread::id id = std::this_thread::get_id()) {
-			_collector_thread_id = id;
+				tracker.trace (obj, [this] (object * target) {
+					_stack.push_back (target);
+				});
+			}
 		}
 
-		gc::reference * reference(object* to);
+	private:
+		std::vector < object * >	_stack;
+	};
 
-		static void reference (gc::reference* ref, object* to);
-		static void dereference (gc::reference* ref);
+	// helper threads trace next to the collector, each one works from its own stack and shares
+	// the surplus through the gray list
+	/// \tparam helper_count threads started for every drain on top of the collector
+	template < std::size_t helper_count = 3 >
+	struct parallel_marking {
+		static constexpr std::size_t local_capacity = 256;
+
+		template < typename tracker_t >
+		void drain(tracker_t & tracker) {
+			// workers with work left, done once every worker runs out
+			std::atomic < std::size_t > busy { helper_count + 1 };
+
+			auto worker = [&tracker, &busy] {
+				std::vector < object * > stack;
+				stack.reserve (local_capacity);
+
+				for (;;) {
+					object * obj = nullptr;
+
+					if (!stack.empty()) {
+						obj = stack.back();
+						stack.pop_back();
+					} else {
+						obj = tracker.pop_gray();
+					}
 
-		template < typename t, typename ... args_t >
-		object * construct(args_t && ... args) {
-			return register_object (
-				new t (std::forward < args_t > (args)...),
-				[](void * payload) {
-					delete static_cast < t * > (payload);
-				});
+					if (obj != nullptr) {
+						tracker.trace (obj, [&tracker, &stack] (object * target) {
+							if (stack.size() < local_capacity) {
+								stack.push_back (target);
+							} else {
+								tracker.push_gray (target);
+							}
+						});
+
+						continue;
+					}
+
+					busy.fetch_sub (1);
+
+					for (;;) {
+						if (tracker.has_gray()) {
+							busy.fetch_add (1);
+							break;
+						}
+
+						if (busy.load() == 0) {
+							return;
+						}
+
+						_mm_pause();
+					}
+				}
+			};
+
+			std::vector < std::jthread > helpers;
+			helpers.reserve (helper_count);
+
+			for (std::size_t i = 0; i < helper_count; ++i) {
+				helpers.emplace_back (worker);
+			}
+
+			worker();
 		}
+	};
 
-		void collect();
+	// -- reclamation strategies --
+	// a strategy decides when the garbage found by a sweep is destroyed, the sweep hands it every
+	// unmarked object between begin_sweep and end_sweep
 
-	private:
+	// the collector destroys the garbage while it sweeps
+	struct eager_reclaim {
+		static constexpr bool concurrent_destructors = false;
 
-		object * register_object (void * payload, dctor_callback dctor);
+		template < typename tracker_t >
+		void begin_sweep(tracker_t &) {}
 
-		object * swap_object_stack_head(object * obj);
-		object * object_stack_head();
+		template < typename tracker_t >
+		void reclaim(tracker_t &, object * obj) {
+			tracker_t::release_object (obj);
+		}
 
-		std::atomic < object* >		_objects { nullptr };
+		template < typename tracker_t >
+		void end_sweep(tracker_t &) {}
 
-		thread_local static object* _object_stack_head;
-		object						_object_stack_root {};
-		std::thread::id				_collector_thread_id;
+		template < typename tracker_t >
+		void allocate(tracker_t &) {}
 	};
 
-	thread_local object * tracker::_object_stack_head = nullptr;
+	// the sweep only unlinks the garbage, allocating threads destroy it a batch at a time so the
+	// destructors run on the threads that need the memory
+	/// \note destructors may run while the collector marks, the references of reclaimed objects skip
+	///       the barrier
+	struct lazy_reclaim {
+		static constexpr bool concurrent_destructors = true;
+		static constexpr std::size_t batch_size = 32;
+
+		template < typename tracker_t >
+		void begin_sweep(tracker_t &) {
+			// whatever the allocating threads left over from the previous cycle goes now, the garbage
+			// waits one cycle at most
+			while (_popping.test_and_set (std::memory_order_acquire)) {
+				_mm_pause();
+			}
+
+			auto * leftover = list_detach (_batches);
 
-	tracker & tracker::instance() {
-		static tracker _instance;
-		return _instance;
-	}
+			_popping.clear (std::memory_order_release);
+
+			while (leftover != nullptr) {
+				auto * next_batch = leftover->next_marked;
 
-	gc::reference * tracker::reference(object* to) {
-		// mark object as active, since we are referencing it
-		if (to != nullptr) {
-			to->state.store (tracking_state::active);
+				release_batch < tracker_t > (leftover);
+
+				leftover = next_batch;
+			}
 		}
 
-		// get the current stack head object
-		auto * from = object_stack_head();
+		template < typename tracker_t >
+		void reclaim(tracker_t &, object * obj) {
+			obj->color.store (reclaimed_color, std::memory_order_relaxed);
 
-		// create reference instance
-		auto * new_ref = new gc::reference {
-			nullptr,
-			to,
-			tracking_state::active,
+			list_push_front (_batch, obj);
+
+			if (++_batch_size == batch_size) {
+				end_batch();
+			}
+		}
+
+		template < typename tracker_t >
+		void end_sweep(tracker_t &) {
+			end_batch();
+		}
+
+		template < typename tracker_t >
+		void allocate(tracker_t &) {
+			if (_batches.load (std::memory_order_relaxed) == nullptr) {
+				return;
+			}
+
+			// one thread pops at a time, the others allocate without waiting. With a single consumer
+			// the popped batch can't be freed under a concurrent pop
+			if (_popping.test_and_set (std::memory_order_acquire)) {
+				return;
+			}
+
+			auto * batch = _batches.load (std::memory_order_acquire);
+
+			while (batch != nullptr && _batches.compare_exchange_weak(
+				batch,
+				batch->next_marked,
+				std::memory_order_acquire,
+				std::memory_order_acquire) == false)
+			{ /* spin */ }
+
+			_popping.clear (std::memory_order_release);
+
+			release_batch < tracker_t > (batch);
+		}
+
+	private:
+
+		// batches are chained through their first object
+		void end_batch () {
+			if (_batch != nullptr) {
+				list_push_front (_batches, _batch, &object::next_marked);
+			}
+
+			_batch = nullptr;
+			_batch_size = 0;
+		}
+
+		template < typename tracker_t >
+		static void release_batch (object * batch) {
+			while (batch != nullptr) {
+				auto * next = batch->next;
+
+				tracker_t::release_object (batch);
+
+				batch = next;
+			}
+		}
+
+		std::atomic < object * >	_batches { nullptr };
+		std::atomic_flag			_popping;
+
+		// batch being filled by the sweep, only touched by the collector
+		object *					_batch { nullptr };
+		std::size_t					_batch_size { 0 };
+	};
+
+	// -- registries --
+	// a registry keeps the objects allocated with each color until the collector takes them over,
+	// which happens once no scope can register with that color anymore
+
+	// every thread registers on its own lists without atomics
+	struct thread_registry {
+		struct thread_state {
+			object *	objects [2] { nullptr, nullptr };
+			object *	objects_tail [2] { nullptr, nullptr };
 		};
 
-		// push to the reference list of the active object
-		list_push_front(from->ref_head, new_ref);
+		void add(thread_state & state, object * obj, uint8_t color) {
+			if (state.objects [color] == nullptr) {
+				state.objects_tail [color] = obj;
+			}
 
-		return new_ref;
-	}
+			list_push_front (state.objects [color], obj);
+		}
+
+		template < typename splice_f >
+		void take(thread_state & state, uint8_t color, splice_f && splice) {
+			if (state.objects [color] != nullptr) {
+				splice (state.objects [color], state.objects_tail [color]);
 
-	void tracker::reference(gc::reference * ref, object * to) {
-		if (to != nullptr) {
-			to->state = tracking_state::active;
+				state.objects [color] = nullptr;
+				state.objects_tail [color] = nullptr;
+			}
 		}
 
-		ref->to.store (to);
-	}
+		template < typename splice_f >
+		void take(uint8_t, splice_f &&) {}
+	};
 
-	void tracker::dereference(gc::reference* ref) {
-		ref->state = tracking_state::unreachable;
-	}
+	// every thread registers on one shared list per color
+	struct global_registry {
+		struct thread_state {};
 
-	void tracker::collect() {
-		if (std::this_thread::get_id() != _collector_thread_id) {
-			throw std::runtime_error ("unexpected thread");
+		void add(thread_state &, object * obj, uint8_t color) {
+			list_push_front (_objects [color], obj);
 		}
 
-		// trace objects
-		{
-			// mark all objects as unreachable
-			for (auto * obj = _objects.load(); obj != nullptr; obj = obj->next) {
-				obj->state.store (tracking_state::unreachable, std::memory_order_release);
+		template < typename splice_f >
+		void take(thread_state &, uint8_t, splice_f &&) {}
+
+		template < typename splice_f >
+		void take(uint8_t color, splice_f && splice) {
+			auto * head = list_detach (_objects [color]);
+
+			if (head == nullptr) {
+				return;
 			}
 
-			// special case for the root object
-			_object_stack_root.state.store (tracking_state::marked, std::memory_order_release);
+			auto * tail = head;
 
-			// mark all objects reachable from the root as active as we can reach them
-			object * next_mark_list = &_object_stack_root;
+			while (tail->next != nullptr) {
+				tail = tail->next;
+			}
 
-			while (next_mark_list != nullptr) {
-				object* mark_list = next_mark_list;
+			splice (head, tail);
+		}
 
-				next_mark_list = nullptr;
+	private:
+		std::atomic < object * >	_objects [2] { nullptr, nullptr };
+	};
 
-				while (mark_list != nullptr) {
+	/// tracks managed objects and the references between them
+	/// \tparam mark_policy order in which the collector traces, see breadth_first_marking
+	/// \tparam reclaim_policy when the garbage is destroyed, see eager_reclaim
+	/// \tparam registry_policy where new objects wait for the collector, see thread_registry
+	/// \note collections run concurrently with the mutators, either from a dedicated collector thread
+	///       (start_collector) or from the thread registered with register_collector_thread. A hybrid
+	///       barrier keeps marking sound: while marking, every reference operation shades the target it
+	///       drops (snapshot at the beginning) and the target it stores, and objects are allocated
+	///       marked. Reference operations run inside mutator scopes, a collector changing phase waits
+	///       for the scopes already running instead of stopping the threads.
+	template < typename mark_policy, typename reclaim_policy, typename registry_policy >
+	struct basic_tracker {
+
+		static basic_tracker & instance () {
+			static basic_tracker _instance;
+			return _instance;
+		}
 
-					// clean up the reference list (TODO: perhaps this should be done on its own "stage")
-					list_collect (mark_list->ref_head,
-						[](struct reference * ref) -> void {
-							delete ref;
-						});
+		~basic_tracker() {
+			stop_collector();
+		}
 
-					for (auto* obj_ref = mark_list->ref_head.load(); obj_ref != nullptr; obj_ref = obj_ref->next) {
-						auto* obj = obj_ref->to.load();
+		void register_collector_thread(std::thread::id id = std::this_thread::get_id()) {
+			_collector_thread_id = id;
+		}
 
-						// skip null or disposed references
-						if (obj == nullptr || obj_ref->state == tracking_state::unreachable) {
-							continue;
-						}
+		/// run collections on a dedicated thread, the calling thread may no longer collect
+		/// \param period time between collections when none is requested
+		void start_collector(std::chrono::milliseconds period = std::chrono::milliseconds { 10 }) {
+			stop_collector();
 
-						if (obj->state == tracking_state::unreachable) {
-							obj->state.store(tracking_state::marked, std::memory_order_release);
+			_collector = std::jthread ([this, period] (std::stop_token stop) {
+				register_collector_thread();
 
-							// push to marked objects
-							list_push_front (next_mark_list, obj, &object::next_marked);
-						}
+				std::unique_lock lock { _collector_lock };
+
+				while (!stop.stop_requested()) {
+					_collector_wakeup.wait_for (lock, stop, period, [this] {
+						return _collect_requested.load (std::memory_order_relaxed);
+					});
+
+					if (stop.stop_requested()) {
+						break;
 					}
 
-					// maintain integrity of the list by popping the head
-					mark_list->state.store (tracking_state::active, std::memory_order_release);
-					list_pop_front (mark_list, &object::next_marked);
+					_collect_requested.store (false, std::memory_order_relaxed);
+
+					lock.unlock();
+					collect();
+
+					// this thread has no use for the references it released
+					hand_back_references();
+					lock.lock();
 				}
+			});
+		}
+
+		/// stop the collector thread, waits for the running cycle
+		void stop_collector() {
+			if (!_collector.joinable()) {
+				return;
 			}
+
+			_collector.request_stop();
+			_collector.join();
+
+			_collector_thread_id = {};
 		}
 
-		// take the garbage out
-		{
-			// collect all unreachable objects
-			list_collect (
-				_objects,
-				[](object* obj) -> void {
-					// release object references
-					list_collect (
-						obj->ref_head,
-						[](gc::reference * ref) -> void {
-							delete ref;
-						},
-						false);
-
-					// call the destructor and release the managed memory
-					obj->dctor (obj->payload);
-					delete obj;
-				});
+		/// ask the collector thread for a cycle, never waits for it
+		void request_collect() {
+			_collect_requested.store (true, std::memory_order_relaxed);
+			_collector_wakeup.notify_one();
 		}
-	}
 
-	object * tracker::swap_object_stack_head(object * obj) {
-		// get the old head
-		auto * old_head = this->object_stack_head();
+		/// number of completed collection cycles
+		uint64_t cycles() const { return _cycles.load(std::memory_order_acquire); }
 
-		// replace the head with the new instance
-		_object_stack_head = obj;
+		// reference operations run inside a scope, scopes nest and cost nothing but the outermost one
+		struct mutator_scope {
+			mutator_scope() { basic_tracker::enter_scope(); }
+			~mutator_scope() { basic_tracker::leave_scope(); }
 
-		return old_head;;
-	}
+			mutator_scope(mutator_scope const &) = delete;
+			mutator_scope & operator = (mutator_scope const &) = delete;
+		};
 
-	object * tracker::object_stack_head() {
-		if (_object_stack_head == nullptr) {
-			_object_stack_head = &_object_stack_root;
-		}
+		// slots on the root stack of every thread
+		static constexpr uint32_t root_stack_capacity = 256;
 
-		return _object_stack_head;
-	}
+		/// while open, gc_ptrs created on the stack of the thread take a slot from its root stack
+		/// instead of registering a reference on the thread root. A slot is a push and a pop, the
+		/// collector scans the root stacks as plain arrays
+		/// \note gc_ptrs taking a slot must not outlive the scope they were created in, slots released
+		///       out of order are only recovered when the scope closes
+		/// \note once the root stack is full new gc_ptrs register as usual
+		struct root_scope {
+			root_scope() : _base { basic_tracker::open_root_scope() } {}
+			~root_scope() { basic_tracker::close_root_scope (_base); }
 
-	object * tracker::register_object(void * payload, dctor_callback dctor) {
+			root_scope(root_scope const &) = delete;
+			root_scope & operator = (root_scope const &) = delete;
 
-		auto * obj = new object {
-			nullptr,
-			nullptr,
-			payload,
-			dctor,
-			tracking_state::active,
-			nullptr
+		private:
+			uint32_t _base;
 		};
 
-		// set the stack line to mantain reference consistency
-		auto* prev_stack_line = swap_object_stack_head (obj);
+		gc::reference * reference(object* to) {
+			mutator_scope scope;
 
-		// push the object to the list
-		list_push_front (_objects, obj);
+			shade (to);
 
-		// restore the stack line
-		swap_object_stack_head (prev_stack_line);
+			// get the current stack head object
+			auto * from = object_stack_head();
 
-		return obj;
-	}
+			auto * record = _mutator;
 
-	template < typename _t >
-	struct gc_ptr {
-	public:
+			// stack handles go on the root stack when a root scope allows it
+			if (from == &record->root && _root_scope_depth != 0) {
+				auto const top = record->root_stack_size.load (std::memory_order_relaxed);
 
-		// -- constructors --
-		constexpr gc_ptr() = default;
+				if (top < root_stack_capacity) {
+					auto * slot = &record->root_stack [top];
 
-		constexpr explicit gc_ptr(std::nullptr_t) : gc_ptr() {}
+					slot->to.store (to, std::memory_order_relaxed);
 
-		gc_ptr(const gc_ptr& x) noexcept {
-			copy(x);
+					// the collector reads the slots below the size
+					record->root_stack_size.store (top + 1, std::memory_order_release);
+
+					return slot;
+				}
+			}
+
+			// create reference instance
+			auto * new_ref = acquire_reference();
+
+			new_ref->to.store (to, std::memory_order_relaxed);
+			new_ref->owner = from;
+
+			// register on the active object
+			if (from == &record->root) {
+				// the collector traces thread roots while their threads push
+				from->refs.lock();
+				from->refs.push (new_ref);
+				from->refs.unlock();
+			} else {
+				// objects under construction are not visible to the collector yet
+				from->refs.push (new_ref);
+			}
+
+			return new_ref;
 		}
 
-		template <typename _u>
-		explicit gc_ptr(const gc_ptr<_u>& x) noexcept {
-			copy(x);
+		static void reference (gc::reference* ref, object* to) {
+			auto & self = instance();
+
+			mutator_scope scope;
+
+			self.shade (ref->to.load (std::memory_order_relaxed));
+			self.shade (to);
+
+			ref->to.store (to, std::memory_order_release);
 		}
 
-		// -- destructor --
-		~gc_ptr() {
-			tracker::dereference(_ref);
+		static void dereference (gc::reference* ref) {
+			auto & self = instance();
+
+			mutator_scope scope;
+
+			if (ref->owner == nullptr) {
+				drop_root_slot (ref);
+				return;
+			}
+
+			auto & owner = *ref->owner;
+
+			if (!reclaim_policy::concurrent_destructors || owner.color.load (std::memory_order_relaxed) != reclaimed_color) {
+				self.shade (ref->to.load (std::memory_order_relaxed));
+			}
+
+			// clear the slot, the reference is free for reuse right away
+			owner.refs.lock();
+			owner.refs.erase (ref);
+			owner.refs.unlock();
+
+			release_reference (ref);
 		}
 
-		// -- operators --
-		gc_ptr& operator = (const gc_ptr& other) noexcept {
-			if (&other == this) return *this;
+		// the header and the payload share a single allocation, the payload is constructed in place
+		// with the new object as stack head so its members register their references on it
+		template < typename t, typename ... args_t >
+		object * construct(args_t && ... args) {
+			static_assert (alignof (t) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over aligned payloads are not supported");
 
-			copy(other);
-			return *this;
+			mutator_scope scope;
+
+			_reclaim.allocate (*this);
+
+			auto * block = static_cast < uint8_t * > (::operator new (payload_offset < t > + sizeof (t)));
+
+			auto * obj = new (block) object {
+				nullptr,
+				nullptr,
+				block + payload_offset < t >,
+				[](void * payload) {
+					static_cast < t * > (payload)->~t ();
+				},
+				mark_color (_epoch.load()),
+				{}
+			};
+
+			auto* prev_stack_line = swap_object_stack_head (obj);
+
+			new (obj->payload) t (std::forward < args_t > (args)...);
+
+			swap_object_stack_head (prev_stack_line);
+
+			// the object is not visible yet, it goes to the list of its allocation color
+			_registry.add (_mutator->registry, obj, obj->color.load (std::memory_order_relaxed));
+
+			return obj;
 		}
 
-		template <typename _u>
-		gc_ptr& operator = (const gc_ptr<_u>& other) noexcept {
-			copy(other);
-			return *this;
+		void collect() {
+			if (std::this_thread::get_id() != _collector_thread_id) {
+				throw std::runtime_error ("unexpected thread");
+			}
+
+			// trace objects
+			{
+				// flip the mark color, every object becomes unmarked and new objects are allocated marked
+				auto const color = static_cast < uint8_t > (mark_color (_epoch.load()) ^ 1);
+
+				_epoch.store (color | marking_flag);
+
+				// from here on every reference operation runs the barrier
+				await_mutator_scopes();
+
+				auto const previous = static_cast < uint8_t > (color ^ 1);
+
+				auto splice = [this] (object * head, object * tail) {
+					tail->next = _objects;
+					_objects = head;
+				};
+
+				// no scope registers objects with the previous color anymore, take them over and trace the
+				// thread roots, those are never swept so their color means nothing
+				_registry.take (previous, splice);
+
+				for (auto * record = _mutators.load(); record != nullptr; record = record->next) {
+					_registry.take (record->registry, previous, splice);
+
+					trace (&record->root, [this] (object * target) {
+						push_gray (target);
+					});
+
+					trace_root_stack (*record);
+				}
+
+				for (;;) {
+					_marking.drain (*this);
+
+					// a scope may have shaded an object without pushing it yet
+					await_mutator_scopes();
+
+					if (!has_gray()) {
+						break;
+					}
+				}
+
+				_epoch.store (color);
+			}
+
+			// take the garbage out
+			{
+				auto const color = mark_color (_epoch.load());
+
+				// objects registered meanwhile wait in the registry and are marked already
+				object * survivors = nullptr;
+
+				_reclaim.begin_sweep (*this);
+
+				for (auto * obj = _objects; obj != nullptr;) {
+					auto * next = obj->next;
+
+					if (obj->color.load (std::memory_order_relaxed) == color) {
+						list_push_front (survivors, obj);
+					} else {
+						_reclaim.reclaim (*this, obj);
+					}
+
+					obj = next;
+				}
+
+				_reclaim.end_sweep (*this);
+
+				_objects = survivors;
+			}
+
+			_cycles.fetch_add (1, std::memory_order_release);
 		}
 
-		_t& operator*() const noexcept {
-			return *operator->();
+	private:
+
+		friend mark_policy;
+		friend reclaim_policy;
+
+		// references are carved out of slabs, each thread acquires and releases them through its own free list
+		static constexpr std::size_t reference_slab_capacity = 1024;
+
+		gc::reference * acquire_reference () {
+			auto * ref = _free_references;
+
+			if (ref == nullptr) {
+				ref = refill_references();
+			}
+
+			_free_references = ref->next;
+			ref->next = nullptr;
+
+			return ref;
 		}
 
-		_t* operator->() const noexcept {
-			return _ptr;
-		}
+		static void release_reference (gc::reference * ref) {
+			if (_free_references == nullptr) {
+				adopt_free_references();
+			}
+
+			ref->next = _free_references;
+			_free_references = ref;
+		}
+
+		gc::reference * refill_references () {
+			adopt_free_references();
+
+			// references left behind by exited threads and collections first
+			if (auto * orphans = list_detach (_orphan_references)) {
+				_free_references = orphans;
+				return orphans;
+			}
+
+			std::scoped_lock lock { _slab_lock };
+
+			auto & slab = _reference_slabs.emplace_back (new gc::reference [reference_slab_capacity]);
+
+			for (std::size_t i = 0; i + 1 < reference_slab_capacity; ++i) {
+				slab [i].next = &slab [i + 1];
+			}
+
+			_free_references = &slab [0];
+			return _free_references;
+		}
+
+		void hand_back_references () {
+			auto * head = _free_references;
+
+			if (head == nullptr) {
+				return;
+			}
+
+			auto * tail = head;
+
+			while (tail->next != nullptr) {
+				tail = tail->next;
+			}
 
-		explicit operator bool() const noexcept {
-			return _ptr != nullptr;
-		}
+			// push the whole chain at once
+			tail->next = _orphan_references.load();
 
-		void reset() noexcept {
-			_ptr = nullptr;
-			_ref->to.store (nullptr);
-		}
+			while (_orphan_references.compare_exchange_weak(
+				tail->next,
+				head,
+				std::memory_order_release,
+				std::memory_order_relaxed) == false)
+			{ /* spin */ }
 
-		template<typename, typename ... _args_tv >
-		friend auto make_gc(_args_tv &&...);
+			_free_references = nullptr;
+		}
 
-		template <typename>
-		friend struct gc_ptr;
+		// hands the free list of an exiting thread back to the tracker
+		struct reference_cache {
+			basic_tracker * owner { nullptr };
 
-	private:
+			~reference_cache() {
+				if (owner != nullptr) {
+					owner->hand_back_references();
+				}
+			}
+		};
 
-		template < typename _u >
-		void copy(gc_ptr <_u> const& other) {
-			_ptr = other._ptr;
-			tracker::reference (_ref, other._ref->to.load());
+		// make sure the free list of the calling thread goes back to the tracker when it exits
+		static void adopt_free_references () {
+			thread_local reference_cache cache;
+			cache.owner = &instance();
 		}
 
-		explicit gc_ptr(object* obj) :
-			_ref{ tracker::instance().reference(obj) },
-			_ptr{ reinterpret_cast <_t*> (obj->payload) }
-		{}
+		// per thread state, the scope sequence is odd while the thread runs a reference operation
+		struct alignas (64) mutator_record {
+			std::atomic < uint64_t >	sequence { 0 };
+			std::atomic_bool			in_use { true };
+			mutator_record *			next { nullptr };
 
-		reference * _ref { tracker::instance().reference(nullptr) };
-		_t * _ptr{ nullptr };
-	};
+			// stack references of the thread hang from its own root or sit on its root stack
+			object						root {};
 
-	template < typename _t, typename ... _args_tv >
-	auto make_gc(_args_tv&& ... args) {
-		return gc::gc_ptr < _t > (
-			gc::tracker::instance().construct < _t, _args_tv... >(std::forward < _args_tv > (args)...));
-	}
-}
+			std::atomic < uint32_t >	root_stack_size { 0 };
+			gc::reference				root_stack [root_stack_capacity] {};
 
-namespace gc2 {
+			typename registry_policy::thread_state
+										registry {};
+		};
 
-	enum struct tracking_state : uint8_t {
-		active,
-		marked,
-		unreachable
-	};
+		// releases the record of an exiting thread
+		struct mutator_slot {
+			mutator_record * record { nullptr };
 
-	using dctor_callback_t = void(*)(void *);
+			~mutator_slot() {
+				if (record != nullptr) {
+					record->in_use.store (false, std::memory_order_release);
+				}
 
-	struct reference {
-		reference*						next { nullptr };
-		std::atomic < struct object* >	to { nullptr };
-		std::atomic < tracking_state >	state { tracking_state::active };
-	};
+				_mutator = nullptr;
+				_object_stack_head = nullptr;
+			}
+		};
 
-	struct object {
-		object*							next { nullptr };
-		object*							next_marked { nullptr };
-		void *							payload { nullptr };
-		dctor_callback_t				dctor { nullptr };
-		std::atomic < reference* >		ref_head { nullptr };
-		std::atomic < tracking_state >	state { tracking_state::active };
-	};
+		static void enter_scope () {
+			if (_scope_depth++ != 0) {
+				return;
+			}
 
-	template < typename t, typename release_f >
-	void atomic_collect (std::atomic < t * > & head, release_f && release, bool check_state = true) {
+			auto * record = _mutator;
 
-		// detach the list
-		auto * detached_head = las::atomic_details::atomic_detach (head);
+			if (record == nullptr) {
+				record = instance().register_mutator();
+			}
 
-		// traverse the list
-		while (detached_head != nullptr) {
-			auto * next_ptr = detached_head->next;
+			// pairs with the phase change in collect, either the collector waits for this scope or the scope sees the new phase
+			record->sequence.store (record->sequence.load (std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+		}
 
-			if (check_state == false || detached_head->state == tracking_state::unreachable) {
-				// remove the object
-				release (detached_head);
-			} else if (detached_head->state == tracking_state::active){
-				// push the object back to the list
-				las::atomic_details::atomic_push (head, detached_head);
-			} else {
-				// something really bad happened
-				throw std::runtime_error ("object marked for collection is still reachable");
+		static void leave_scope () {
+			if (--_scope_depth != 0) {
+				return;
 			}
 
-			detached_head = next_ptr;
+			_mutator->sequence.store (_mutator->sequence.load (std::memory_order_relaxed) + 1, std::memory_order_release);
 		}
-	}
 
-	struct tracker {
+		static uint32_t open_root_scope () {
+			mutator_scope scope;
 
-		static tracker & instance ();
+			++_root_scope_depth;
 
-		void register_collector_thread(std::thread::id id = std::this_thread::get_id()) {
-			_collector_thread_id = id;
+			return _mutator->root_stack_size.load (std::memory_order_relaxed);
 		}
 
-		gc2::reference * reference(object* to);
+		// the slots above the base belong to handles of the scope, they are all gone by now
+		static void close_root_scope (uint32_t base) {
+			--_root_scope_depth;
 
-		static void reference (gc2::reference* ref, object* to);
-		static void dereference (gc2::reference* ref);
-
-		template < typename t, typename ... args_t >
-		object * construct(args_t && ... args) {
-			return register_object (
-				new t (std::forward < args_t > (args)...),
-				[](void * payload) {
-					delete static_cast < t * > (payload);
-				});
+			_mutator->root_stack_size.store (base, std::memory_order_release);
 		}
 
-		void collect();
+		static void drop_root_slot (gc::reference * slot) {
+			auto & self = instance();
+			auto * record = _mutator;
 
-	private:
+			self.shade (slot->to.load (std::memory_order_relaxed));
+			slot->to.store (nullptr, std::memory_order_relaxed);
 
-		object * register_object (void * payload, dctor_callback_t dctor);
+			// handles go in reverse order, the top slot pops right away
+			auto const top = record->root_stack_size.load (std::memory_order_relaxed);
+
+			if (slot == &record->root_stack [top - 1]) {
+				record->root_stack_size.store (top - 1, std::memory_order_release);
+			}
+		}
 
-		object * swap_object_stack_head(object * obj);
-		object * object_stack_head();
+		mutator_record * register_mutator () {
+			// releases the record when the thread exits
+			thread_local mutator_slot slot;
 
-		std::atomic < object* >		_objects { nullptr };
+			// reuse the record of an exited thread
+			for (auto * record = _mutators.load(); record != nullptr; record = record->next) {
+				bool expected = false;
 
-		thread_local static object* _object_stack_head;
-		object						_object_stack_root {};
-		std::thread::id				_collector_thread_id;
-	};
+				if (record->in_use.compare_exchange_strong (expected, true)) {
+					slot.record = record;
+					_mutator = record;
+					return record;
+				}
+			}
 
-	thread_local object * tracker::_object_stack_head = nullptr;
+			auto * record = new mutator_record {};
 
-	tracker & tracker::instance() {
-		static tracker _instance;
-		return _instance;
-	}
+			list_push_front (_mutators, record);
 
-	gc2::reference * tracker::reference(object* to) {
-		// mark object as active, since we are referencing it
-		if (to != nullptr) {
-			to->state.store (tracking_state::active);
+			slot.record = record;
+			_mutator = record;
+			return record;
 		}
 
-		// get the current stack head object
-		auto * from = object_stack_head();
+		// wait for every scope that was running when called, the ones entered afterwards don't matter
+		void await_mutator_scopes () {
+			for (auto * record = _mutators.load(); record != nullptr; record = record->next) {
+				auto const sequence = record->sequence.load();
 
-		// create reference instance
-		auto * new_ref = new gc2::reference {
-			nullptr,
-			to,
-			tracking_state::active,
-		};
+				if ((sequence & 1) == 0) {
+					continue;
+				}
 
-		// push to the reference list of the active object
-		las::atomic_details::atomic_push (from->ref_head, new_ref);
+				for (uint32_t spin = 0; record->sequence.load() == sequence; ++spin) {
+					if (spin < 64) {
+						_mm_pause();
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			}
+		}
 
-		return new_ref;
-	}
+		// turn a white object gray, true when the caller has to trace it
+		bool mark (object * obj) {
+			auto const epoch = _epoch.load();
 
-	void tracker::reference(gc2::reference * ref, object * to) {
-		if (to != nullptr) {
-			to->state = tracking_state::active;
-		}
+			// barriers are off outside marking
+			if (obj == nullptr || (epoch & marking_flag) == 0) {
+				return false;
+			}
 
-		ref->to.store (to);
-	}
+			auto const color = mark_color (epoch);
 
-	void tracker::dereference(gc2::reference* ref) {
-		ref->state = tracking_state::unreachable;
-	}
+			// cheap check first, most targets are marked already
+			return obj->color.load (std::memory_order_relaxed) != color && obj->color.exchange (color) != color;
+		}
 
-	void tracker::collect() {
-		if (std::this_thread::get_id() != _collector_thread_id) {
-			throw std::runtime_error ("unexpected thread");
+		void shade (object * obj) {
+			if (mark (obj)) {
+				push_gray (obj);
+			}
 		}
 
-		// trace objects
-		{
-			// mark all objects as unreachable
-			for (auto * obj = _objects.load(std::memory_order_relaxed); obj != nullptr; obj = obj->next) {
-				obj->state.store (tracking_state::unreachable, std::memory_order_release);
+		// the slots of a root stack change under the scan, a slot popped meanwhile still held a live
+		// target during this cycle
+		void trace_root_stack (mutator_record & record) {
+			auto const size = record.root_stack_size.load (std::memory_order_acquire);
 
-				// clean up the reference list while we are at it
-				atomic_collect (obj->ref_head,
-					[](struct reference * ref) -> void {
-						delete ref;
-					});
+			for (uint32_t i = 0; i < size; ++i) {
+				shade (record.root_stack [i].to.load (std::memory_order_acquire));
 			}
+		}
 
-			// special case for the root object
-			_object_stack_root.state.store (tracking_state::marked, std::memory_order_release);
+		// mark the targets of an object, the sink receives the ones the caller has to trace
+		template < typename sink_f >
+		void trace (object * obj, sink_f && sink) {
+			auto & refs = obj->refs;
 
-			// mark all objects reachable from the root as active as we can reach them
-			object * next_mark_list = &_object_stack_root;
+			// squeeze out the unregistered slots while marking the targets
+			refs.lock();
 
-			while (next_mark_list != nullptr) {
-				// traverse the current mark list and store the next mark list
-				object* mark_list = next_mark_list;
-				next_mark_list = nullptr;
+			refs.compact ([this, &sink] (gc::reference * ref) {
+				auto * target = ref->to.load (std::memory_order_acquire);
 
-				while (mark_list != nullptr) {
+				if (mark (target)) {
+					sink (target);
+				}
+			});
 
-					for (auto* obj_ref = mark_list->ref_head.load(std::memory_order_relaxed); obj_ref != nullptr; obj_ref = obj_ref->next) {
-						auto* obj = obj_ref->to.load();
+			refs.unlock();
+		}
 
-						// skip null or disposed references
-						if (obj == nullptr || obj_ref->state == tracking_state::unreachable) {
-							continue;
-						}
+		// gray objects shared with the barriers, an object turns gray once per cycle so popping
+		// can't run into a recycled head
+		void push_gray (object * obj) {
+			list_push_front (_gray, obj, &object::next_marked);
+		}
 
-						if (obj->state == tracking_state::unreachable) {
-							obj->state.store(tracking_state::marked, std::memory_order_release);
+		object * pop_gray () {
+			auto * head = _gray.load (std::memory_order_acquire);
 
-							// push to marked objects
-							obj->next_marked = next_mark_list;
-							next_mark_list = obj;
-						}
-					}
+			while (head != nullptr && _gray.compare_exchange_weak(
+				head,
+				head->next_marked,
+				std::memory_order_acq_rel,
+				std::memory_order_acquire) == false)
+			{ /* spin */ }
 
-					// mark object as active, next
-					mark_list->state.store (tracking_state::active, std::memory_order_release);
-					mark_list = mark_list->next_marked;
-				}
-			}
+			return head;
 		}
 
-		// take the garbage out
-		{
-			// collect all unreachable objects
-			atomic_collect (
-				_objects,
-				[](object* obj) -> void {
-					// release object references
-					atomic_collect (
-						obj->ref_head,
-						[](gc2::reference * ref) -> void {
-							delete ref;
-						},
-						false);
-
-					// call the destructor and release the managed memory
-					obj->dctor (obj->payload);
-					delete obj;
-				});
+		object * take_gray () {
+			return list_detach (_gray);
 		}
-	}
 
-	object * tracker::swap_object_stack_head(object * obj) {
-		// get the old head
-		auto * old_head = this->object_stack_head();
+		bool has_gray () const {
+			return _gray.load (std::memory_order_acquire) != nullptr;
+		}
 
-		// replace the head with the new instance
-		_object_stack_head = obj;
+		static void release_object (object * obj) {
+			// call the destructor first, members dereference the references they own
+			obj->dctor (obj->payload);
 
-		return old_head;;
-	}
+			// release the references registered on the object and not disposed by its destructor
+			obj->refs.compact (release_reference);
 
-	object * tracker::object_stack_head() {
-		if (_object_stack_head == nullptr) {
-			_object_stack_head = &_object_stack_root;
+			// header and payload go in one go
+			obj->~object();
+			::operator delete (obj);
 		}
 
-		return _object_stack_head;
-	}
+		object * swap_object_stack_head(object * obj) {
+			// get the old head
+			auto * old_head = this->object_stack_head();
 
-	object * tracker::register_object(void * payload, dctor_callback_t dctor) {
+			// replace the head with the new instance
+			_object_stack_head = obj;
 
-		auto * obj = new object {
-			nullptr,
-			nullptr,
-			payload,
-			dctor,
-			nullptr,
-			tracking_state::active,
-		};
+			return old_head;;
+		}
 
-		// set the stack line to mantain reference consistency
-		auto* prev_stack_line = swap_object_stack_head (obj);
+		object * object_stack_head() {
+			// threads start from their own root
+			if (_object_stack_head == nullptr) {
+				_object_stack_head = &_mutator->root;
+			}
 
-		// push the object to the list
-		las::atomic_details::atomic_push (_objects, obj);
+			return _object_stack_head;
+		}
 
-		// restore the stack line
-		swap_object_stack_head (prev_stack_line);
+		// only touched by the collector
+		object*						_objects { nullptr };
 
-		return obj;
-	}
+		static inline thread_local object* _object_stack_head = nullptr;
+		std::thread::id				_collector_thread_id;
+
+		static inline thread_local gc::reference * _free_references = nullptr;
+		std::atomic < gc::reference* >	_orphan_references { nullptr };
+
+		std::mutex					_slab_lock;
+		std::vector < std::unique_ptr < gc::reference [] > >
+									_reference_slabs;
+
+		// the mark color and the marking flag change together, a thread allocating with the new
+		// color must also see the barriers enabled
+		static constexpr uint8_t	marking_flag = 2;
+
+		static uint8_t mark_color (uint8_t epoch) { return epoch & 1; }
+
+		std::atomic < uint8_t >		_epoch { 0 };
+		std::atomic < object* >		_gray { nullptr };
+
+		mark_policy					_marking;
+		reclaim_policy				_reclaim;
+		registry_policy				_registry;
+
+		static inline thread_local mutator_record *	_mutator = nullptr;
+		static inline thread_local uint32_t			_scope_depth = 0;
+		static inline thread_local uint32_t			_root_scope_depth = 0;
+		std::atomic < mutator_record* >				_mutators { nullptr };
+
+		// collector thread
+		std::jthread				_collector;
+		std::mutex					_collector_lock;
+		std::condition_variable_any	_collector_wakeup;
+		std::atomic_bool			_collect_requested { false };
+		std::atomic < uint64_t >	_cycles { 0 };
+	};
+
+	using tracker = basic_tracker < breadth_first_marking, eager_reclaim, thread_registry >;
+	using root_scope = tracker::root_scope;
+
+	template < typename _t, typename tracker_t = tracker >
+	struct gc_ptr;
+
+	template < typename _t, typename tracker_t = tracker, typename ... _args_tv >
+	auto make_gc(_args_tv&& ... args);
 
-	template < typename _t >
+	template < typename _t, typename tracker_t >
 	struct gc_ptr {
 	public:
 
@@ -660,13 +1192,13 @@ namespace gc2 {
 		}
 
 		template <typename _u>
-		explicit gc_ptr(const gc_ptr<_u>& x) noexcept {
+		explicit gc_ptr(const gc_ptr<_u, tracker_t>& x) noexcept {
 			copy(x);
 		}
 
 		// -- destructor --
 		~gc_ptr() {
-			tracker::dereference(_ref);
+			tracker_t::dereference(_ref);
 		}
 
 		// -- operators --
@@ -678,7 +1210,7 @@ namespace gc2 {
 		}
 
 		template <typename _u>
-		gc_ptr& operator = (const gc_ptr<_u>& other) noexcept {
+		gc_ptr& operator = (const gc_ptr<_u, tracker_t>& other) noexcept {
 			copy(other);
 			return *this;
 		}
@@ -697,36 +1229,41 @@ namespace gc2 {
 
 		void reset() noexcept {
 			_ptr = nullptr;
-			_ref->to.store (nullptr);
+			tracker_t::reference (_ref, nullptr);
 		}
 
-		template<typename, typename ... _args_tv >
+		template<typename, typename, typename ... _args_tv >
 		friend auto make_gc(_args_tv &&...);
 
-		template <typename>
+		template <typename, typename>
 		friend struct gc_ptr;
 
 	private:
 
 		template < typename _u >
-		void copy(gc_ptr <_u> const& other) {
+		void copy(gc_ptr <_u, tracker_t> const& other) {
+			typename tracker_t::mutator_scope scope;
+
 			_ptr = other._ptr;
-			tracker::reference (_ref, other._ref->to.load());
+			tracker_t::reference (_ref, other._ref->to.load(std::memory_order_relaxed));
 		}
 
 		explicit gc_ptr(object* obj) :
-			_ref{ tracker::instance().reference(obj) },
+			_ref{ tracker_t::instance().reference(obj) },
 			_ptr{ reinterpret_cast <_t*> (obj->payload) }
 		{}
 
-		reference * _ref { tracker::instance().reference(nullptr) };
+		reference * _ref { tracker_t::instance().reference(nullptr) };
 		_t * _ptr{ nullptr };
 	};
 
-	template < typename _t, typename ... _args_tv >
+	template < typename _t, typename tracker_t, typename ... _args_tv >
 	auto make_gc(_args_tv&& ... args) {
-		return gc2::gc_ptr < _t > (
-			gc2::tracker::instance().construct < _t, _args_tv... >(std::forward < _args_tv > (args)...));
+		// the new object is only reachable once the handle exists, keep both in the same scope
+		typename tracker_t::mutator_scope scope;
+
+		return gc::gc_ptr < _t, tracker_t > (
+			tracker_t::instance().template construct < _t, _args_tv... >(std::forward < _args_tv > (args)...));
 	}
 }
 
@@ -755,6 +1292,31 @@ void gc_alloc_assign(benchmark::State &state) {
 	}
 }
 
+// every benchmark thread assigns into its own node while the collector thread keeps up
+void gc_alloc_assign_threaded(benchmark::State &state) {
+	auto & tracker = gc::tracker::instance();
+
+	if (state.thread_index() == 0) {
+		tracker.start_collector();
+	}
+
+	auto root = gc::make_gc<demo>();
+	auto node = root;
+
+	for (auto _ : state) {
+
+		for (std::size_t i = 0; i < state.range(0); ++i) {
+			node->to = gc::make_gc < demo > ();
+		}
+	}
+
+	if (state.thread_index() == 0) {
+		tracker.stop_collector();
+	}
+
+	state.SetItemsProcessed (static_cast < int64_t > (state.iterations() * state.range(0)));
+}
+
 void gc_collect(benchmark::State &state) {
 	gc::tracker::instance().register_collector_thread();
 
@@ -774,6 +1336,217 @@ void gc_collect(benchmark::State &state) {
 	}
 }
 
+// nearest rank percentile of sorted samples
+double sample_percentile (std::vector < int64_t > const & sorted, double percentile) {
+	if (sorted.empty()) {
+		return 0.0;
+	}
+
+	auto const rank = static_cast < std::size_t > (percentile / 100.0 * static_cast < double > (sorted.size() - 1) + 0.5);
+	return static_cast < double > (sorted [rank]);
+}
+
+// latency of single assignments while a live chain of range(0) objects is collected every few
+// allocations, either inline on the mutator or on the collector thread
+template < bool background >
+void gc_mutator_latency(benchmark::State &state) {
+	constexpr std::size_t operations = 1 << 14;
+	constexpr std::size_t collect_interval = 1 << 10;
+
+	using clock = std::chrono::steady_clock;
+
+	auto & tracker = gc::tracker::instance();
+
+	if constexpr (background) {
+		tracker.start_collector();
+	} else {
+		tracker.register_collector_thread();
+	}
+
+	// live set every cycle has to trace
+	auto root = gc::make_gc<demo>();
+	{
+		auto node = root;
+
+		for (int64_t i = 0; i < state.range(0); ++i) {
+			node->to = gc::make_gc < demo > ();
+			node = node->to;
+		}
+	}
+
+	auto churn = gc::make_gc<demo>();
+
+	std::vector < int64_t > samples;
+	samples.reserve (operations);
+
+	auto const first_cycle = tracker.cycles();
+
+	for (auto _ : state) {
+		for (std::size_t i = 0; i < operations; ++i) {
+			auto const start = clock::now();
+
+			churn->to = gc::make_gc < demo > ();
+
+			if ((i + 1) % collect_interval == 0) {
+				if constexpr (background) {
+					tracker.request_collect();
+				} else {
+					tracker.collect();
+				}
+			}
+
+			samples.push_back (std::chrono::duration_cast < std::chrono::nanoseconds > (clock::now() - start).count());
+		}
+	}
+
+	auto const cycles = tracker.cycles() - first_cycle;
+
+	if constexpr (background) {
+		tracker.stop_collector();
+	}
+
+	std::sort (samples.begin(), samples.end());
+
+	state.counters ["p50_ns"] = sample_percentile (samples, 50.0);
+	state.counters ["p99_ns"] = sample_percentile (samples, 99.0);
+	state.counters ["p999_ns"] = sample_percentile (samples, 99.9);
+	state.counters ["max_ns"] = samples.empty() ? 0.0 : static_cast < double > (samples.back());
+	state.counters ["cycles"] = static_cast < double > (cycles);
+}
+
+void gc_mutator_latency_inline(benchmark::State &state) {
+	gc_mutator_latency < false > (state);
+}
+
+void gc_mutator_latency_background(benchmark::State &state) {
+	gc_mutator_latency < true > (state);
+}
+
+// short lived stack handles into a live chain, registered on the thread root as references or
+// held on the root stack of a root scope
+template < bool scoped >
+void gc_local_churn(benchmark::State &state) {
+	gc::tracker::instance().register_collector_thread();
+
+	auto root = gc::make_gc<demo>();
+	root->to = gc::make_gc<demo>();
+
+	auto const count = static_cast < std::size_t > (state.range(0));
+
+	auto churn = [&root, count] {
+		for (std::size_t i = 0; i < count; ++i) {
+			gc::gc_ptr < demo > node = root;
+			gc::gc_ptr < demo > next = node->to;
+
+			benchmark::DoNotOptimize (next.operator->());
+		}
+	};
+
+	for (auto _ : state) {
+		if constexpr (scoped) {
+			gc::root_scope scope;
+			churn();
+		} else {
+			churn();
+		}
+	}
+
+	state.SetItemsProcessed (static_cast < int64_t > (state.iterations() * count * 2));
+}
+
+void gc_local_churn_registered(benchmark::State &state) {
+	gc_local_churn < false > (state);
+}
+
+void gc_local_churn_scoped(benchmark::State &state) {
+	gc_local_churn < true > (state);
+}
+
+// -- tracker matrix --
+// the same workloads for every combination of marking, reclamation and registry
+
+template < typename tracker_t >
+struct tree_node {
+	uint8_t xxx[object_size];
+	gc::gc_ptr < tree_node, tracker_t > left;
+	gc::gc_ptr < tree_node, tracker_t > right;
+};
+
+// complete binary tree of count nodes, built level by level
+template < typename tracker_t >
+gc::gc_ptr < tree_node < tracker_t >, tracker_t > make_tree (std::size_t count) {
+	using node_ptr = gc::gc_ptr < tree_node < tracker_t >, tracker_t >;
+
+	std::vector < node_ptr > nodes;
+	nodes.reserve (count);
+
+	for (std::size_t i = 0; i < count; ++i) {
+		nodes.push_back (gc::make_gc < tree_node < tracker_t >, tracker_t > ());
+	}
+
+	for (std::size_t i = count; i-- > 1;) {
+		auto & parent = nodes [(i - 1) / 2];
+
+		if (i % 2 == 1) {
+			parent->left = nodes [i];
+		} else {
+			parent->right = nodes [i];
+		}
+	}
+
+	return nodes.front();
+}
+
+// a cycle over a live tree of range(0) nodes plus as much garbage
+template < typename tracker_t >
+void gc_collect_matrix(benchmark::State &state) {
+	auto & tracker = tracker_t::instance();
+	tracker.register_collector_thread();
+
+	auto const count = static_cast < std::size_t > (state.range(0));
+	auto live = make_tree < tracker_t > (count);
+
+	tracker.collect();
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		make_tree < tracker_t > (count);
+		state.ResumeTiming();
+
+		tracker.collect();
+	}
+
+	state.SetItemsProcessed (static_cast < int64_t > (state.iterations() * count * 2));
+}
+
+// every benchmark thread assigns into its own node while the collector thread keeps up
+template < typename tracker_t >
+void gc_alloc_assign_matrix(benchmark::State &state) {
+	using node_t = tree_node < tracker_t >;
+
+	auto & tracker = tracker_t::instance();
+
+	if (state.thread_index() == 0) {
+		tracker.start_collector();
+	}
+
+	auto node = gc::make_gc < node_t, tracker_t > ();
+	auto const count = static_cast < std::size_t > (state.range(0));
+
+	for (auto _ : state) {
+
+		for (std::size_t i = 0; i < count; ++i) {
+			node->left = gc::make_gc < node_t, tracker_t > ();
+		}
+	}
+
+	if (state.thread_index() == 0) {
+		tracker.stop_collector();
+	}
+
+	state.SetItemsProcessed (static_cast < int64_t > (state.iterations() * count));
+}
+
 struct no_gc_demo {
 	uint8_t xxx[object_size];
 	no_gc_demo *cenas;
@@ -869,54 +1642,31 @@ void shared_ptr_collect_baseline(benchmark::State &state) {
 	}
 }
 
-struct demo2 {
-	uint8_t xxx[object_size];
-	gc2::gc_ptr <demo2> to;
-};
-
-void gc2_alloc_assign(benchmark::State &state) {
-	gc2::tracker::instance().register_collector_thread();
-
-	auto root = gc2::make_gc<demo2>();
-	auto node = root;
-
-	for (auto _ : state) {
-
-		for (std::size_t i = 0; i < state.range(0); ++i) {
-			node->to = gc2::make_gc < demo2 > ();
-		}
-
-		state.PauseTiming();
-		gc2::tracker::instance().collect();
-		state.ResumeTiming();
-	}
-}
-
-void gc2_collect(benchmark::State &state) {
-	gc2::tracker::instance().register_collector_thread();
-
-	auto root = gc2::make_gc<demo2>();
-	auto node = root;
-
-	for (auto _ : state) {
-		state.PauseTiming();
-
-		for (std::size_t i = 0; i < state.range(0); ++i) {
-			node->to = gc2::make_gc < demo2 > ();
-		}
-
-		state.ResumeTiming();
-
-		gc2::tracker::instance().collect();
-	}
-}
-
 #define GC_BENCHMARK(func) BENCHMARK(func)->Range(1 << 8, 1 << 18)->Unit(benchmark::TimeUnit::kMillisecond)
 //GC_BENCHMARK(no_gc_baseline_alloc);
 //GC_BENCHMARK(no_gc_baseline_collect);
-//GC_BENCHMARK(shared_ptr_alloc_baseline);
+GC_BENCHMARK(shared_ptr_alloc_baseline);
 //GC_BENCHMARK(shared_ptr_collect_baseline);
 GC_BENCHMARK(gc_alloc_assign);
+GC_BENCHMARK(gc_alloc_assign_threaded)->ThreadRange(1, 8)->UseRealTime();
 GC_BENCHMARK(gc_collect);
-//GC_BENCHMARK(gc2_alloc_assign);
-//GC_BENCHMARK(gc2_collect);
+BENCHMARK(gc_mutator_latency_inline)->Range(1 << 10, 1 << 16)->Unit(benchmark::TimeUnit::kMillisecond);
+BENCHMARK(gc_mutator_latency_background)->Range(1 << 10, 1 << 16)->Unit(benchmark::TimeUnit::kMillisecond);
+GC_BENCHMARK(gc_local_churn_registered);
+GC_BENCHMARK(gc_local_churn_scoped);
+
+#define GC_MATRIX_BENCHMARK(func, mark, reclaim, registry) BENCHMARK_TEMPLATE(func, gc::basic_tracker < mark, reclaim, registry >)->Unit(benchmark::TimeUnit::kMillisecond)
+#define GC_COLLECT_MATRIX(mark, reclaim) GC_MATRIX_BENCHMARK(gc_collect_matrix, mark, reclaim, gc::thread_registry)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)
+#define GC_ALLOC_MATRIX(reclaim, registry) GC_MATRIX_BENCHMARK(gc_alloc_assign_matrix, gc::breadth_first_marking, reclaim, registry)->Range(1 << 12, 1 << 16)->ThreadRange(1, 4)->UseRealTime()
+
+GC_COLLECT_MATRIX(gc::breadth_first_marking, gc::eager_reclaim);
+GC_COLLECT_MATRIX(gc::depth_first_marking, gc::eager_reclaim);
+GC_COLLECT_MATRIX(gc::parallel_marking <>, gc::eager_reclaim);
+GC_COLLECT_MATRIX(gc::breadth_first_marking, gc::lazy_reclaim);
+GC_COLLECT_MATRIX(gc::depth_first_marking, gc::lazy_reclaim);
+GC_COLLECT_MATRIX(gc::parallel_marking <>, gc::lazy_reclaim);
+
+GC_ALLOC_MATRIX(gc::eager_reclaim, gc::thread_registry);
+GC_ALLOC_MATRIX(gc::eager_reclaim, gc::global_registry);
+GC_ALLOC_MATRIX(gc::lazy_reclaim, gc::thread_registry);
+GC_ALLOC_MATRIX(gc::lazy_reclaim, gc::global_registry);
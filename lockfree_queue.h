@@ -0,0 +1,126 @@
+#pragma once
+#ifndef LOCKFREE_QUEUE_H
+#define LOCKFREE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace lf {
+
+	/// intrusive chain link used by the mpsc queue
+	/// \note node types pushed into a mpsc_queue must inherit from this link
+	struct mpsc_link {
+		std::atomic < mpsc_link * > next { nullptr };
+	};
+
+	/// an unbounded intrusive multiple producer, single consumer fifo queue
+	/// \tparam node_t the node type, must inherit from mpsc_link
+	/// \note based on Dmitry Vyukov's intrusive mpsc node based queue. Producers are wait free
+	///       (a single exchange per push) and the consumer pops in O(1) without any read-modify-write
+	///       on the fast path. The queue does not own the nodes, their lifetime is managed by the caller.
+	template < typename node_t >
+	struct mpsc_queue {
+	public:
+		static_assert (std::is_base_of_v < mpsc_link, node_t >, "queue node type must inherit from lf::mpsc_link");
+
+		using node_pointer = node_t *;
+
+		mpsc_queue () = default;
+
+		mpsc_queue (mpsc_queue const &) = delete;
+		mpsc_queue (mpsc_queue &&) = delete;
+
+		mpsc_queue & operator = (mpsc_queue const &) = delete;
+		mpsc_queue & operator = (mpsc_queue &&) = delete;
+
+		/// check if the queue is empty
+		/// \return true if there are no nodes visible to the consumer
+		/// \note only safe to call from the consumer thread
+		[[nodiscard]] bool empty () const {
+			return _tail == &_stub && _stub.next.load (std::memory_order_acquire) == nullptr;
+		}
+
+		/// push a node to the back of the queue
+		/// \param node_ptr the node to push
+		/// \note wait free, safe to call from any thread
+		void push (node_pointer node_ptr) {
+			link_range (node_ptr, node_ptr);
+		}
+
+		/// push a pre linked sequence of nodes to the back of the queue
+		/// \param first the first node of the sequence
+		/// \param last the last node of the sequence
+		/// \note the sequence must be chained from first to last through mpsc_link::next
+		/// \note wait free, safe to call from any thread
+		void push (node_pointer first, node_pointer last) {
+			link_range (first, last);
+		}
+
+		/// pop a node from the front of the queue
+		/// \return the popped node or nullptr if the queue is empty
+		/// \note only safe to call from the consumer thread
+		/// \note may return nullptr while a producer is halfway through a push, the node will
+		///       become visible as soon as the producer links it
+		[[nodiscard]] node_pointer pop () {
+			auto * tail = _tail;
+			auto * next = tail->next.load (std::memory_order_acquire);
+
+			// skip the stub node if it is at the front
+			if (tail == &_stub) {
+				if (next == nullptr) {
+					return nullptr;
+				}
+
+				_tail = next;
+				tail = next;
+				next = next->next.load (std::memory_order_acquire);
+			}
+
+			// common case, the tail has a successor
+			if (next != nullptr) {
+				_tail = next;
+				return static_cast < node_pointer > (tail);
+			}
+
+			// a producer has exchanged the head but did not link it yet
+			if (tail != _head.load (std::memory_order_acquire)) {
+				return nullptr;
+			}
+
+			// tail is the last node, reinsert the stub so the tail can be unhooked
+			link_range (&_stub, &_stub);
+
+			next = tail->next.load (std::memory_order_acquire);
+
+			if (next != nullptr) {
+				_tail = next;
+				return static_cast < node_pointer > (tail);
+			}
+
+			return nullptr;
+		}
+
+	private:
+
+		void link_range (mpsc_link * first, mpsc_link * last) {
+			last->next.store (nullptr, std::memory_order_relaxed);
+
+			// serialization point for producers
+			auto * prev = _head.exchange (last, std::memory_order_acq_rel);
+
+			// link the previous head, from here on the consumer can see the sequence
+			prev->next.store (first, std::memory_order_release);
+		}
+
+		// producers and the consumer live on separate cache lines
+		alignas (64)
+		std::atomic < mpsc_link * > _head { &_stub };
+
+		alignas (64)
+		mpsc_link *					_tail { &_stub };
+		mpsc_link					_stub;
+	};
+}
+
+#endif
@@ -3,6 +3,7 @@
 #define LOCKFREE_STACK_H
 
 #include <atomic>
+#include <cstddef>
 #include <functional>
 #include <immintrin.h>
 #include <memory>
@@ -84,6 +85,45 @@ namespace lf {
 			return old_head;
 		}
 
+		/// unhooks up to count nodes from the top of a linked list with a single compare and swap
+		/// \tparam node_t the type of the node
+		/// \param head the head of the linked list
+		/// \param count the maximum number of nodes to unhook
+		/// \param first the first unhooked node, nullptr if nothing was unhooked
+		/// \param last the last unhooked node, nullptr if nothing was unhooked
+		/// \return the number of unhooked nodes
+		/// \note the unhooked sequence is NOT terminated, use the returned count to traverse it
+		template < typename node_t >
+		std::size_t pop (std::atomic < node_t * > & head, std::size_t count, node_t * & first, node_t * & last) {
+			first = head.load (std::memory_order_relaxed);
+			last = nullptr;
+
+			if (count == 0) {
+				first = nullptr;
+				return 0;
+			}
+
+			while (first) {
+				std::size_t popped = 1;
+				last = first;
+
+				// find the last node of the sequence
+				while (popped < count && last->next) {
+					last = last->next;
+					++popped;
+				}
+
+				if (compare_and_swap (head, first, last->next)) {
+					return popped;
+				}
+
+				_mm_pause();
+			}
+
+			last = nullptr;
+			return 0;
+		}
+
 		/// unhooks the full linked list from the head
 		/// \tparam node_t the type of the node
 		/// \param head the head of the linked list
@@ -158,20 +198,13 @@ namespace lf {
 		}
 
 		/// get the size of the stack
+		/// \note exact when the stack is quiescent, approximate while other threads are pushing or popping
 		[[nodiscard]] size_type size() const { return _impl.size (); }
 
 		/// clear the stack
 		void clear () {
-			auto const GUARD = _collector.guard ();
-
-			// highjack the active chain links and if there is a chain
-			// push it to the collector
-			if (auto * detached_list = _impl.detach ()) {
-				_collector.push (detached_list, atomics::find_tail (detached_list));
-			}
-
-			// we try to collect any way
-			_collector.try_collect ();
+			// highjack the active chain links, destroy the values and push the chain to the collector
+			drain ([](value_type &&) {});
 		}
 
 		/// push a new value to the stack
@@ -181,7 +214,7 @@ namespace lf {
 			auto * new_node = _impl.allocate();
 
 			// copy the value into its place
-			_allocator.construct (new_node->data (), value);
+			alloc_traits::construct (_allocator, new_node->data (), value);
 
 			// push the new node to the stack
 			_impl.push (new_node);
@@ -194,7 +227,7 @@ namespace lf {
 			auto * new_node = _impl.allocate ();
 
 			// move the value to its place
-			_allocator.construct (new_node->data (), std::forward < value_type > (value));
+			alloc_traits::construct (_allocator, new_node->data (), std::forward < value_type > (value));
 
 			// push the new node to the stack
 			_impl.push (new_node);
@@ -211,7 +244,7 @@ namespace lf {
 			auto * new_node = _impl.allocate();
 
 			// construct the value in place
-			_allocator.construct (new_node->data (), std::forward < args_tv > (args)...);
+			alloc_traits::construct (_allocator, new_node->data (), std::forward < args_tv > (args)...);
 
 			// push the new node to the stack
 			_impl.push (new_node);
@@ -236,7 +269,7 @@ namespace lf {
 				result = std::move (*unhocked->data ());
 
 				// destroy the remaining value in the node
-				_allocator.destroy (unhocked->data ());
+				alloc_traits::destroy (_allocator, unhocked->data ());
 
 				// push the node to the collector
 				_collector.push (unhocked);
@@ -248,6 +281,104 @@ namespace lf {
 			return result;
 		}
 
+		/// push a range of values to the stack with a single compare and swap
+		/// \tparam input_iterator_t the type of the input iterator
+		/// \param first the beginning of the range
+		/// \param last the end of the range
+		/// \note the last value of the range ends up at the top of the stack, as if pushed one by one
+		template < typename input_iterator_t >
+		void push_range (input_iterator_t first, input_iterator_t last) {
+			node_pointer chain_head = nullptr;
+			node_pointer chain_tail = nullptr;
+			size_type count = 0;
+
+			// build the chain locally, no contention here
+			for (; first != last; ++first) {
+				auto * new_node = _impl.allocate ();
+
+				alloc_traits::construct (_allocator, new_node->data (), *first);
+
+				new_node->next = chain_head;
+				chain_head = new_node;
+
+				if (!chain_tail) {
+					chain_tail = new_node;
+				}
+
+				++count;
+			}
+
+			// publish the whole chain at once
+			if (chain_head) {
+				_impl.push (chain_head, chain_tail, count);
+			}
+		}
+
+		/// pop up to count values from the stack with a single compare and swap
+		/// \tparam output_iterator_t the type of the output iterator
+		/// \param count the maximum number of values to pop
+		/// \param out the output iterator to move the popped values into
+		/// \return the number of popped values
+		/// \note values are written in pop order, top of the stack first
+		template < typename output_iterator_t >
+		size_type pop_n (size_type count, output_iterator_t out) {
+			// declare ourselfs as a critical client
+			auto const GUARD = _collector.guard ();
+
+			node_pointer first = nullptr;
+			node_pointer last = nullptr;
+
+			auto const POPPED = _impl.pop (count, first, last);
+
+			if (POPPED != 0) {
+				auto * it = first;
+
+				for (size_type i = 0; i < POPPED; ++i, it = it->next) {
+					*out = std::move (*it->data ());
+					++out;
+
+					alloc_traits::destroy (_allocator, it->data ());
+				}
+
+				_collector.push (first, last);
+			}
+
+			_collector.try_collect ();
+
+			return POPPED;
+		}
+
+		/// detach every value from the stack and visit it, without any per value compare and swap
+		/// \tparam visitor_t the type of the visitor
+		/// \param visitor the visitor, called with each value as an rvalue, top of the stack first
+		/// \return the number of visited values
+		template < typename visitor_t >
+		size_type drain (visitor_t && visitor) {
+			// declare ourselfs as a critical client
+			auto const GUARD = _collector.guard ();
+
+			size_type count = 0;
+
+			if (auto * detached_list = _impl.detach ()) {
+				node_pointer tail = nullptr;
+
+				for (auto * it = detached_list; it; it = it->next) {
+					std::invoke (visitor, std::move (*it->data ()));
+					alloc_traits::destroy (_allocator, it->data ());
+
+					tail = it;
+					++count;
+				}
+
+				_impl.release_size (count);
+				_collector.push (detached_list, tail);
+			}
+
+			_collector.try_collect ();
+
+			return count;
+		}
+
 	private:
 		/// storage chain link and value container
 		struct node {
@@ -269,6 +400,41 @@ namespace lf {
 
 		using alloc_rebind_type = typename alloc_traits::template rebind_alloc < node >;
 
+		/// per thread sharded element counter, keeps the size off the head cache line
+		/// \note each thread updates its own shard, shards are only summed when the size is requested
+		struct size_counter {
+			static constexpr std::size_t shard_count = 16;
+
+			void add (std::ptrdiff_t delta) {
+				_shards [this_thread_shard ()].value.fetch_add (delta, std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] std::size_t sum () const {
+				std::ptrdiff_t total = 0;
+
+				for (auto const & shard : _shards) {
+					total += shard.value.load (std::memory_order_relaxed);
+				}
+
+				// shards are read one at a time, under load a pop may be seen before its push
+				return total > 0 ? static_cast < std::size_t > (total) : 0;
+			}
+
+		private:
+			struct alignas (64) shard {
+				std::atomic < std::ptrdiff_t > value { 0 };
+			};
+
+			static std::size_t this_thread_shard () {
+				static std::atomic_size_t next_shard { 0 };
+				thread_local std::size_t const SHARD = next_shard.fetch_add (1, std::memory_order_relaxed) % shard_count;
+
+				return SHARD;
+			}
+
+			shard _shards [shard_count];
+		};
+
 		// allocate and manage the internal linked list
 		struct stack_impl : alloc_rebind_type {
 			using alloc_rebind_type::alloc_rebind_type;
@@ -278,7 +444,7 @@ namespace lf {
 			explicit stack_impl (alloc_rebind_type && other) : alloc_rebind_type (other) {}
 
 			[[nodiscard]] bool empty () const { return _head.load (std::memory_order_relaxed) == nullptr; }
-			[[nodiscard]] std::size_t size () const { return _size.load (std::memory_order_relaxed); }
+			[[nodiscard]] std::size_t size () const { return _size.sum (); }
 
 			node_pointer allocate () {
 				return alloc_rebind_type::allocate (1);
@@ -286,12 +452,32 @@ namespace lf {
 
 			void push (node_pointer new_node) {
 				atomics::push (_head, new_node);
-				++_size;
+				_size.add (1);
+			}
+
+			void push (node_pointer first, node_pointer last, std::size_t count) {
+				atomics::push (_head, first, last);
+				_size.add (static_cast < std::ptrdiff_t > (count));
 			}
 
 			node_pointer pop () {
-				--_size;
-				return atomics::pop (_head);
+				auto * popped = atomics::pop (_head);
+
+				if (popped) {
+					_size.add (-1);
+				}
+
+				return popped;
+			}
+
+			std::size_t pop (std::size_t count, node_pointer & first, node_pointer & last) {
+				auto const POPPED = atomics::pop (_head, count, first, last);
+				_size.add (-static_cast < std::ptrdiff_t > (POPPED));
+				return POPPED;
+			}
+
+			void release_size (std::size_t count) {
+				_size.add (-static_cast < std::ptrdiff_t > (count));
 			}
 
 			node_pointer detach () {
@@ -300,7 +486,7 @@ namespace lf {
 
 		private:
 			atomic_node_ptr		_head { nullptr };
-			std::atomic_size_t	_size { 0 };
+			size_counter		_size;
 		};
 
 		/// track and manage the number of concurrent critical clients
@@ -1,10 +1,19 @@
 #include <lockfree_stack.h>
-#include <las/test/concurrent_stress_tester.hpp>
-#include <las/test/random.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <optional>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
+
+using soak_clock = std::chrono::steady_clock;
 
 enum struct run_duration {
     small,
@@ -25,9 +34,41 @@ bool from_string (std::string_view string_value, run_duration & out) {
         match ("large", run_duration::large);
 }
 
+/// parse a wall clock duration, accepts an optional 's', 'm' or 'h' suffix (defaults to seconds)
+bool from_string (std::string_view string_value, std::chrono::seconds & out) {
+    if (string_value.empty ()) {
+        return false;
+    }
+
+    auto multiplier = 1;
+
+    switch (string_value.back ()) {
+        case 'h': multiplier = 3600; string_value.remove_suffix (1); break;
+        case 'm': multiplier = 60; string_value.remove_suffix (1); break;
+        case 's': string_value.remove_suffix (1); break;
+        default: break;
+    }
+
+    try {
+        std::size_t parsed = 0;
+        auto const VALUE = std::stoll (std::string (string_value), &parsed);
+
+        if (parsed != string_value.size () || VALUE <= 0) {
+            return false;
+        }
+
+        out = std::chrono::seconds { VALUE * multiplier };
+        return true;
+    } catch (std::exception const &) {
+        return false;
+    }
+}
+
 void print_usage (int const ARG_C, char const * const * ARG_V) {
-    std::cerr << "Usage: " << ARG_V[0] << " [run_duration]" << std::endl;
+    std::cerr << "Usage: " << ARG_V[0] << " [run_duration] [--duration <time>] [--threads <count>]" << std::endl;
     std::cerr << "\trun_duration: Optional. Values: 'small', 'medium', 'large'. Defaults to 'small'" << std::endl;
+    std::cerr << "\t--duration: Optional. Run for a wall clock time instead of a fixed number of operations. Ex: '90s', '30m', '8h'" << std::endl;
+    std::cerr << "\t--threads: Optional. Number of worker threads. Defaults to the hardware concurrency" << std::endl;
 }
 
 std::optional < std::size_t > map_duration_to_iterations (run_duration duration) {
@@ -46,17 +87,287 @@ std::optional < std::size_t > map_duration_to_iterations (run_duration duration)
     return std::nullopt;
 }
 
+// maximum operations per thread before a round reaches its verification checkpoint
+constexpr std::size_t ROUND_OPERATIONS = 1U << 17U;
+// maximum wall time of a round, also the reporting interval
+constexpr auto REPORT_INTERVAL = std::chrono::seconds { 1 };
+// maximum number of values moved by push_range / pop_n
+constexpr std::size_t MAX_BATCH_SIZE = 8;
+
+/// values carry the producer id in the upper bits and the producer sequence number in the lower bits
+namespace soak_value {
+    constexpr unsigned SEQUENCE_BITS = 48;
+    constexpr uint64_t SEQUENCE_MASK = (uint64_t { 1 } << SEQUENCE_BITS) - 1;
+
+    constexpr uint64_t make (std::size_t producer, uint64_t sequence) {
+        return (static_cast < uint64_t > (producer) << SEQUENCE_BITS) | sequence;
+    }
+
+    constexpr std::size_t producer (uint64_t value) { return static_cast < std::size_t > (value >> SEQUENCE_BITS); }
+    constexpr uint64_t sequence (uint64_t value) { return value & SEQUENCE_MASK; }
+}
+
+/// log-linear latency histogram, 16 linear sub buckets per power of two
+struct latency_histogram {
+    static constexpr std::size_t SUB_BUCKETS = 16;
+    static constexpr std::size_t BUCKETS = 64 * SUB_BUCKETS;
+
+    void record (uint64_t nanoseconds) {
+        ++_buckets [index_of (nanoseconds)];
+        ++_count;
+        _max = std::max (_max, nanoseconds);
+    }
+
+    void merge (latency_histogram const & other) {
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            _buckets [i] += other._buckets [i];
+        }
+
+        _count += other._count;
+        _max = std::max (_max, other._max);
+    }
+
+    /// \return the upper bound of the bucket holding the requested percentile
+    [[nodiscard]] uint64_t percentile (double pct) const {
+        auto const TARGET = static_cast < uint64_t > (static_cast < double > (_count) * pct / 100.0);
+        uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += _buckets [i];
+
+            if (seen > TARGET) {
+                return std::min (upper_bound_of (i), _max);
+            }
+        }
+
+        return _max;
+    }
+
+    [[nodiscard]] uint64_t count () const { return _count; }
+    [[nodiscard]] uint64_t max () const { return _max; }
+
+private:
+    static std::size_t index_of (uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast < std::size_t > (value);
+        }
+
+        auto const MAGNITUDE = static_cast < std::size_t > (std::bit_width (value)) - 5;
+        auto const SUB = static_cast < std::size_t > (value >> MAGNITUDE) - SUB_BUCKETS;
+
+        return (MAGNITUDE + 1) * SUB_BUCKETS + SUB;
+    }
+
+    static uint64_t upper_bound_of (std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+
+        auto const MAGNITUDE = index / SUB_BUCKETS - 1;
+        auto const SUB = index % SUB_BUCKETS + SUB_BUCKETS;
+
+        return ((SUB + 1) << MAGNITUDE) - 1;
+    }
+
+    std::vector < uint64_t >    _buckets = std::vector < uint64_t > (BUCKETS, 0);
+    uint64_t                    _count { 0 };
+    uint64_t                    _max { 0 };
+};
+
+/// per worker state, producer id is the worker index
+struct worker_state {
+    std::size_t                 id { 0 };
+    std::mt19937_64             random;
+
+    // sequence of the next value this worker pushes
+    uint64_t                    next_sequence { 0 };
+
+    // last value this worker popped that it also produced, and how many values it
+    // had pushed at that point. Every own value pushed after the popped one and before
+    // the pop was sitting on top of it, so none of them may be popped afterwards
+    std::optional < uint64_t >  last_own_popped;
+    uint64_t                    last_own_popped_watermark { 0 };
+
+    std::vector < uint64_t >    popped;
+    latency_histogram           latency;
+    std::size_t                 operations { 0 };
+    std::size_t                 lifo_violations { 0 };
+
+    void record_pop (uint64_t value) {
+        popped.push_back (value);
+
+        if (soak_value::producer (value) != id) {
+            return;
+        }
+
+        auto const SEQUENCE = soak_value::sequence (value);
+
+        if (last_own_popped && SEQUENCE > *last_own_popped && SEQUENCE < last_own_popped_watermark) {
+            ++lifo_violations;
+
+            std::cerr << "LIFO violation: worker " << id
+                << " popped own sequence " << SEQUENCE
+                << " after sequence " << *last_own_popped
+                << " which was below it" << std::endl;
+        }
+
+        last_own_popped = SEQUENCE;
+        last_own_popped_watermark = next_sequence;
+    }
+
+    void reset_round () {
+        last_own_popped.reset ();
+        last_own_popped_watermark = 0;
+        popped.clear ();
+        latency = {};
+        operations = 0;
+        lifo_violations = 0;
+    }
+};
+
+using soak_stack = lf::stack < uint64_t >;
+
+void run_operation (soak_stack & stack, worker_state & worker) {
+    auto const OPERATION = worker.random () % 100;
+
+    if (OPERATION < 40) {
+        stack.push (soak_value::make (worker.id, worker.next_sequence++));
+    } else if (OPERATION < 80) {
+        if (auto const VALUE = stack.pop ()) {
+            worker.record_pop (*VALUE);
+        }
+    } else if (OPERATION < 89) {
+        uint64_t values [MAX_BATCH_SIZE];
+        auto const COUNT = 1 + worker.random () % MAX_BATCH_SIZE;
+
+        for (std::size_t i = 0; i < COUNT; ++i) {
+            values [i] = soak_value::make (worker.id, worker.next_sequence++);
+        }
+
+        stack.push_range (values, values + COUNT);
+    } else if (OPERATION < 98) {
+        uint64_t values [MAX_BATCH_SIZE];
+        auto const POPPED = stack.pop_n (1 + worker.random () % MAX_BATCH_SIZE, values);
+
+        for (std::size_t i = 0; i < POPPED; ++i) {
+            worker.record_pop (values [i]);
+        }
+    } else {
+        // drain stands in for clear, so every removed value is still accounted for
+        stack.drain ([&](uint64_t value) { worker.record_pop (value); });
+    }
+}
+
+void run_worker (soak_stack & stack, worker_state & worker, std::size_t operations, soak_clock::time_point deadline) {
+    for (std::size_t i = 0; i < operations; ++i) {
+        // check the deadline every now and then to keep the clock off the hot path
+        if ((i & 0xFFU) == 0 && soak_clock::now () >= deadline) {
+            break;
+        }
+
+        auto const START = soak_clock::now ();
+        run_operation (stack, worker);
+        auto const END = soak_clock::now ();
+
+        worker.latency.record (static_cast < uint64_t > (
+            std::chrono::duration_cast < std::chrono::nanoseconds > (END - START).count ()));
+        ++worker.operations;
+    }
+}
+
+/// check that every value pushed during the round was popped exactly once, or is still in the stack
+/// \return the number of accounting errors
+std::size_t verify_round (
+    soak_stack & stack,
+    std::vector < worker_state > & workers,
+    std::vector < uint64_t > const & round_first_sequence,
+    std::size_t & remaining)
+{
+    // the stack is quiescent, its size must be exact
+    auto const REPORTED_SIZE = stack.size ();
+
+    std::vector < uint64_t > leftovers;
+    remaining = stack.drain ([&](uint64_t value) { leftovers.push_back (value); });
+
+    std::size_t errors = 0;
+
+    if (REPORTED_SIZE != remaining) {
+        std::cerr << "size mismatch: size () reported " << REPORTED_SIZE << " but " << remaining << " values were left" << std::endl;
+        ++errors;
+    }
+
+    // one counter per value pushed this round, per producer
+    std::vector < std::vector < uint8_t > > seen (workers.size ());
+
+    for (std::size_t p = 0; p < workers.size (); ++p) {
+        seen [p].assign (workers [p].next_sequence - round_first_sequence [p], 0);
+    }
+
+    auto account = [&](uint64_t value) {
+        auto const PRODUCER = soak_value::producer (value);
+        auto const SEQUENCE = soak_value::sequence (value);
+
+        if (PRODUCER >= workers.size () ||
+            SEQUENCE < round_first_sequence [PRODUCER] ||
+            SEQUENCE >= workers [PRODUCER].next_sequence)
+        {
+            std::cerr << "unknown value: producer " << PRODUCER << " sequence " << SEQUENCE << std::endl;
+            ++errors;
+            return;
+        }
+
+        auto & count = seen [PRODUCER][SEQUENCE - round_first_sequence [PRODUCER]];
+
+        if (count != 0) {
+            std::cerr << "duplicate value: producer " << PRODUCER << " sequence " << SEQUENCE << std::endl;
+            ++errors;
+        }
+
+        count = 1;
+    };
+
+    for (auto const & worker : workers) {
+        std::ranges::for_each (worker.popped, account);
+    }
+
+    std::ranges::for_each (leftovers, account);
+
+    for (std::size_t p = 0; p < workers.size (); ++p) {
+        auto const LOST = std::ranges::count (seen [p], 0);
+
+        if (LOST != 0) {
+            std::cerr << "lost values: producer " << p << " lost " << LOST << " values" << std::endl;
+            errors += static_cast < std::size_t > (LOST);
+        }
+    }
+
+    return errors;
+}
+
 int main (int const ARG_C, char const * const * ARG_V) {
 
     run_duration duration = run_duration::small;
+    std::optional < std::chrono::seconds > wall_duration;
+    std::size_t thread_count = std::max (2U, std::thread::hardware_concurrency ());
+
+    for (int i = 1; i < ARG_C; ++i) {
+        std::string_view const ARG { ARG_V[i] };
+
+        if (ARG == "--duration" && i + 1 < ARG_C) {
+            std::chrono::seconds value {};
+
+            if (!from_string (ARG_V[++i], value)) {
+                print_usage (ARG_C, ARG_V);
+                return 1;
+            }
 
-    if (ARG_C == 2) {
-        if (!from_string (ARG_V[1], duration)) {
+            wall_duration = value;
+        } else if (ARG == "--threads" && i + 1 < ARG_C) {
+            thread_count = std::max (1, std::atoi (ARG_V[++i]));
+        } else if (!from_string (ARG, duration)) {
             print_usage (ARG_C, ARG_V);
+            return 1;
         }
-    } else if (ARG_C > 2) {
-        print_usage (ARG_C, ARG_V);
-        return 1;
     }
 
     auto const OPT_ITER = map_duration_to_iterations (duration);
@@ -66,20 +377,119 @@ int main (int const ARG_C, char const * const * ARG_V) {
         return 1;
     }
 
-    std::cout << "Running with " << *OPT_ITER << " iterations" << std::endl;
+    if (wall_duration) {
+        std::cout << "Running for " << wall_duration->count () << " seconds";
+    } else {
+        std::cout << "Running with " << *OPT_ITER << " iterations per thread";
+    }
+
+    std::cout << " on " << thread_count << " threads" << std::endl;
 
     // test infrastructure
-    lf::stack < uint_fast32_t > stack;
-    las::test::concurrent_stress_tester stress {};
+    soak_stack stack;
+    std::vector < worker_state > workers (thread_count);
 
-    for (int i = 10; i < OPT_ITER.value(); ++i) {
-        stress.dispatch ({
-                { [&]{ stack.push (las::test::uniform (1000)); }, 50 },
-                { [&]{ auto _ = stack.pop (); }, 50 },
-                {[&]{ stack.clear (); }, 5 },
-            },
-            i);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        workers [i].id = i;
+        workers [i].random.seed (i + 1);
     }
 
+    auto const START = soak_clock::now ();
+    auto const END = wall_duration ? START + *wall_duration : soak_clock::time_point::max ();
+
+    std::size_t operations_left = *OPT_ITER;
+    std::size_t total_operations = 0;
+
+    // statistics accumulated over the rounds of a reporting interval
+    latency_histogram interval_latency;
+    std::size_t interval_operations = 0;
+    std::size_t interval_rounds = 0;
+    auto interval_start = START;
+
+    for (std::size_t round = 0;; ++round) {
+        auto const ROUND_START = soak_clock::now ();
+
+        if (wall_duration ? ROUND_START >= END : operations_left == 0) {
+            break;
+        }
+
+        auto const ROUND_OPS = wall_duration ? ROUND_OPERATIONS : std::min (ROUND_OPERATIONS, operations_left);
+        auto const DEADLINE = std::min (END, ROUND_START + REPORT_INTERVAL);
+
+        std::vector < uint64_t > round_first_sequence (thread_count);
+
+        for (std::size_t i = 0; i < thread_count; ++i) {
+            workers [i].reset_round ();
+            round_first_sequence [i] = workers [i].next_sequence;
+        }
+
+        // run the round
+        {
+            std::vector < std::thread > threads;
+            threads.reserve (thread_count);
+
+            for (auto & worker : workers) {
+                threads.emplace_back ([&] { run_worker (stack, worker, ROUND_OPS, DEADLINE); });
+            }
+
+            for (auto & thread : threads) {
+                thread.join ();
+            }
+        }
+
+        auto const ROUND_END = soak_clock::now ();
+
+        // checkpoint, every thread is stopped
+        std::size_t remaining = 0;
+        auto errors = verify_round (stack, workers, round_first_sequence, remaining);
+
+        std::size_t round_operations = 0;
+
+        for (auto const & worker : workers) {
+            interval_latency.merge (worker.latency);
+            round_operations += worker.operations;
+            errors += worker.lifo_violations;
+        }
+
+        total_operations += round_operations;
+        interval_operations += round_operations;
+        ++interval_rounds;
+
+        if (!wall_duration) {
+            operations_left -= std::min (operations_left, round_operations / thread_count);
+        }
+
+        auto const LAST_ROUND = wall_duration ? ROUND_END >= END : operations_left == 0;
+
+        if (errors != 0 || LAST_ROUND || ROUND_END - interval_start >= REPORT_INTERVAL) {
+            auto const INTERVAL_SECONDS = std::chrono::duration < double > (ROUND_END - interval_start).count ();
+            auto const ELAPSED_SECONDS = std::chrono::duration < double > (ROUND_END - START).count ();
+
+            std::cout << std::fixed << std::setprecision (1)
+                << "[" << ELAPSED_SECONDS << "s] rounds " << interval_rounds << " (last " << round << ")"
+                << " | " << interval_operations << " ops, "
+                << static_cast < double > (interval_operations) / INTERVAL_SECONDS / 1e6 << " Mops/s"
+                << " | latency ns p50 " << interval_latency.percentile (50.0)
+                << " p99 " << interval_latency.percentile (99.0)
+                << " p99.9 " << interval_latency.percentile (99.9)
+                << " max " << interval_latency.max ()
+                << " | left in stack " << remaining
+                << " | errors " << errors
+                << std::endl;
+
+            interval_latency = {};
+            interval_operations = 0;
+            interval_rounds = 0;
+            interval_start = ROUND_END;
+        }
+
+        if (errors != 0) {
+            std::cerr << "FAILED at round " << round << " after " << total_operations << " operations" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "PASSED " << total_operations << " operations" << std::endl;
+
     return 0;
-}
\ No newline at end of file
+}